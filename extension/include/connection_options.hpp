@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include <tuple>
+
+// Client side options of the connections to a server. Connections opened with different options
+// are not interchangeable, so the options are part of the key connection pools are shared by.
+struct ConnectionOptions
+{
+  // protocol compression algorithm: empty for none, "zlib" or "zstd"
+  std::string compression;
+  // zstd level from 1 to 22, 0 for the default of the client library (3); zlib has no level to pick
+  int compressionLevel = 0;
+
+  std::tuple<std::string, int> key() const
+  {
+    return std::make_tuple(compression, compressionLevel);
+  }
+};
@@ -3,29 +3,78 @@
 #include <jdbc/mysql_driver.h>
 #include <jdbc/mysql_connection.h>
 
+#include "connection_options.hpp"
+
+#include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include <map>
-#include <queue>
+#include <deque>
+#include <vector>
 #include <string>
 
+// Counters of the connections a caller got from a pool
+struct ConnectionPoolStats
+{
+  // connections handed out by getConnection
+  std::atomic<uint64_t> checkouts{0};
+  // connections opened, by getConnection or warmUp
+  std::atomic<uint64_t> creates{0};
+  // waits of getConnection for a connection to be released, and their time in microseconds
+  std::atomic<uint64_t> waits{0};
+  std::atomic<uint64_t> waitMicros{0};
+};
+
 class ConnectionPool
 {
 private:
+  struct PooledConnection
+  {
+    sql::Connection *connection;
+    std::chrono::steady_clock::time_point lastUsed;
+  };
+
   sql::mysql::MySQL_Driver *driver;
-  std::queue<sql::Connection*> connections = std::queue<sql::Connection*>();
+  // idle connections, the most recently used at the back
+  std::deque<PooledConnection> connections;
   std::mutex connectionsMutex;
+  std::condition_variable connectionReleased;
+  // idle, checked out and being created connections
+  int openConnections = 0;
   int maxPoolSize;
   int minPoolSize;
   std::string host;
   std::string username;
   std::string password;
+  ConnectionOptions options;
+
+  // how long getConnection waits for a connection when the pool is at its maximum size
+  std::chrono::milliseconds acquireTimeout = std::chrono::seconds(30);
+  // connections idle for longer are checked with a server round trip before being handed out
+  std::chrono::milliseconds validationInterval = std::chrono::seconds(30);
+  // connections idle for longer are closed, down to minPoolSize
+  std::chrono::milliseconds idleTimeout = std::chrono::minutes(5);
+
+  void closeConnections(std::vector<sql::Connection *> &toClose);
+  void evictIdleConnections(std::vector<sql::Connection *> &toClose);
+  // returns nullptr instead of waiting when the pool is at its maximum size and wait is false
+  sql::Connection *acquireConnection(ConnectionPoolStats *stats, bool wait);
 
 public:
-  ConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password);
+  ConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password,
+                 const ConnectionOptions& options = ConnectionOptions());
   sql::Connection *createConnection(int retryLeftCount);
-  sql::Connection *getConnection();
+  // counts the checkout in stats when given
+  sql::Connection *getConnection(ConnectionPoolStats *stats = nullptr);
+  // same as getConnection, but returns nullptr right away when all the connections of the pool are in use
+  sql::Connection *tryGetConnection(ConnectionPoolStats *stats = nullptr);
   void releaseConnection(sql::Connection *connection);
+  // opens connections in parallel until count of them are open, bounded by maxPoolSize
+  void warmUp(int count, ConnectionPoolStats *stats = nullptr);
+  // raises the maximum number of connections, never lowers it
+  void ensureMaxPoolSize(int size);
   void close();
   ~ConnectionPool();
 };
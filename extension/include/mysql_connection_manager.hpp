@@ -7,11 +7,13 @@
 
 class MySQLConnectionManager {
 private:
-    static std::map<std::tuple<std::string, std::string, std::string>, ConnectionPool*> connectionMap;
+    static std::map<std::tuple<std::string, std::string, std::string, std::tuple<std::string, int>>, ConnectionPool*> connectionMap;
     static std::mutex mapMutex;
 
 public:
-    static ConnectionPool* getConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password);
+    static ConnectionPool* getConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password,
+                                             const ConnectionOptions& options = ConnectionOptions());
+    // closes the pools of the server and user, whatever their connection options
     static void close(const std::string& host, const std::string& username, const std::string& password);
     ~MySQLConnectionManager();
 };
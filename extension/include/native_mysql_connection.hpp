@@ -0,0 +1,26 @@
+#pragma once
+
+#include <mysql.h>
+
+#include "connection_options.hpp"
+
+#include <string>
+
+// Thin owner of a libmysqlclient handle, used by the native scan engine which talks
+// the binary protocol directly instead of going through Connector/C++.
+class NativeMysqlConnection
+{
+private:
+  MYSQL *mysql = nullptr;
+
+public:
+  NativeMysqlConnection(const std::string &host, const std::string &username, const std::string &password,
+                        const ConnectionOptions &options = ConnectionOptions());
+  MYSQL *get() const { return mysql; }
+  void close();
+  ~NativeMysqlConnection();
+
+  // Splits a Connector/C++ style host ("tcp://host:port", "unix:///path/to/socket", "host:port" or "host")
+  // into the parts expected by mysql_real_connect.
+  static void parseHost(const std::string &host, std::string &hostname, unsigned int &port, std::string &socket);
+};
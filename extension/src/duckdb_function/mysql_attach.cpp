@@ -5,6 +5,11 @@
 #include "../state/mysql_global_state.hpp"
 #include "paged_mysql_state.hpp"
 #include "../model/attach_function_data.cpp"
+#include "mysql_metadata.cpp"
+#include "mysql_connection_options.cpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+
+#include <thread>
 
 using namespace duckdb;
 
@@ -20,6 +25,10 @@ static unique_ptr<FunctionData> AttachBind(ClientContext &context, TableFunction
 
 	for (auto &kv : input.named_parameters)
 	{
+		if (MysqlSetConnectionOption(result->connection_options, kv.first, kv.second))
+		{
+			continue;
+		}
 		if (kv.first == "source_schema")
 		{
 			result->source_schema = StringValue::Get(kv.second);
@@ -37,6 +46,7 @@ static unique_ptr<FunctionData> AttachBind(ClientContext &context, TableFunction
 			result->filter_pushdown = BooleanValue::Get(kv.second);
 		}
 	}
+	MysqlCheckConnectionOptions(result->connection_options);
 
 	return_types.push_back(LogicalType::BOOLEAN);
 	names.emplace_back("Success");
@@ -52,32 +62,72 @@ static void AttachFunction(ClientContext &context, TableFunctionInput &data_p, D
 		return;
 	}
 
-	gstate.pool = MySQLConnectionManager::getConnectionPool(1, 5, data.host, data.username, data.password);
-	auto conn = gstate.pool->getConnection();
+	gstate.pool = MySQLConnectionManager::getConnectionPool(1, 5, data.host, data.username, data.password, data.connection_options);
 
-	auto dconn = Connection(context.db->GetDatabase(context));
-	auto stmt = conn->createStatement();
-	auto res = stmt->executeQuery(StringUtil::Format(
-			R"(
-			SELECT table_name
-			FROM   information_schema.tables 
-			WHERE  table_schema = '%s';
-			)",
-			data.source_schema));
+	// the metadata of every table comes with a single query and is handed to the binds of mysql_scan, so that
+	// creating each view needs no round trip to MySQL whatever the TTL, and cached for the later binds
+	auto tables = GetSchemaMetadata(gstate.pool, data.source_schema);
+	auto &cache = MysqlMetadataCache::Get();
+	for (auto &table : tables)
+	{
+		cache.Seed(data.host, data.username, data.source_schema, table.first, table.second);
+		if (MysqlMetadataCacheTTL(context) > 0)
+		{
+			cache.Store(data.host, data.username, data.source_schema, table.first, table.second);
+		}
+	}
 
-	while (res->next())
+	vector<string> table_names;
+	for (auto &table : tables)
 	{
-		auto mysql_str = res->getString(1);
-		auto table_name = mysql_str.c_str();
+		table_names.push_back(table.first);
+	}
 
-		dconn
-				.TableFunction(data.filter_pushdown ? "mysql_scan_pushdown" : "mysql_scan",
-											 {Value(data.host), Value(data.username), Value(data.password), Value(data.source_schema), Value(table_name)})
-				->CreateView(data.sink_schema, table_name, data.overwrite, false);
+	// the views are created concurrently, each worker on its own connection
+	auto scan_parameters = MysqlConnectionParameters(data.connection_options);
+	auto &db = DatabaseInstance::GetDatabase(context);
+	auto worker_count = MinValue<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads(), table_names.size());
+	atomic<idx_t> next_table {0};
+	mutex error_lock;
+	std::exception_ptr error;
+	vector<std::thread> workers;
+	for (idx_t worker_idx = 0; worker_idx < worker_count; worker_idx++)
+	{
+		workers.emplace_back([&]()
+												 {
+			try {
+				auto dconn = Connection(db);
+				for (auto table_idx = next_table++; table_idx < table_names.size(); table_idx = next_table++)
+				{
+					auto &table_name = table_names[table_idx];
+					dconn
+							.TableFunction(data.filter_pushdown ? "mysql_scan_pushdown" : "mysql_scan",
+														 {Value(data.host), Value(data.username), Value(data.password), Value(data.source_schema), Value(table_name)},
+														 scan_parameters)
+							->CreateView(data.sink_schema, table_name, data.overwrite, false);
+				}
+			} catch (...) {
+				lock_guard<mutex> guard(error_lock);
+				if (!error)
+				{
+					error = std::current_exception();
+				}
+				// the other workers stop after their current view
+				next_table = table_names.size();
+			} });
+	}
+	for (auto &worker : workers)
+	{
+		worker.join();
+	}
+	for (auto &table : tables)
+	{
+		cache.Unseed(data.host, data.username, data.source_schema, table.first);
+	}
+	if (error)
+	{
+		std::rethrow_exception(error);
 	}
-	res->close();
-	stmt->close();
-	gstate.pool->releaseConnection(conn);
 
 	data.finished = true;
 }
\ No newline at end of file
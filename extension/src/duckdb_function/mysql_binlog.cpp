@@ -0,0 +1,567 @@
+#include "duckdb.hpp"
+
+#include "mysql_jdbc.h"
+#include "mysql_connection_manager.hpp"
+#include "mysql_connection_options.cpp"
+#include "mysql_metadata.cpp"
+#include "../state/mysql_binlog_state.hpp"
+#include "../transformer/duckdb_to_mysql_literal.cpp"
+#include "../transformer/mysql_binlog_to_duckdb_result.cpp"
+
+#include <cstring>
+#include <spdlog/spdlog.h>
+
+using namespace duckdb;
+
+// flag of COM_BINLOG_DUMP: the server ends the dump at the end of its binlog instead of waiting for new events
+#ifndef BINLOG_DUMP_NON_BLOCK
+#define BINLOG_DUMP_NON_BLOCK 1
+#endif
+
+// _binlog_file, _binlog_position and _gtid, set per transaction, come before the decoded rows
+#define MYSQL_BINLOG_TRANSACTION_COLUMNS 3
+
+// SELECT * FROM mysql_binlog('localhost', 'repl', '', 'shop', 'orders', binlog_file='binlog.000042', binlog_position=157)
+struct BinlogFunctionData : public TableFunctionData
+{
+	string host;
+	string username;
+	string password;
+	string schema_name;
+	string table_name;
+
+	ConnectionOptions connection_options;
+	// where the dump starts: a position in a binlog file, or after the transactions of a GTID set
+	string binlog_file;
+	int64_t binlog_position = 4;
+	string gtid_set;
+	int64_t server_id = 0;
+
+	vector<MysqlBinlogColumn> columns;
+	// _op and the columns of the table
+	vector<LogicalType> row_types;
+};
+
+// Parses "uuid:1-5:7,uuid:1-3" into the encoding of COM_BINLOG_DUMP_GTID: the number of server ids, then for each
+// its 16 bytes and its intervals, as [start, end) pairs, all the integers being 8 bytes little endian
+static string MysqlBinlogEncodeGtidSet(const string &gtid_set)
+{
+	auto append_int = [](string &result, uint64_t value)
+	{
+		for (idx_t i = 0; i < 8; i++)
+		{
+			result += (char)((value >> (8 * i)) & 0xFF);
+		}
+	};
+
+	vector<string> sids;
+	for (auto &sid : StringUtil::Split(gtid_set, ","))
+	{
+		StringUtil::Trim(sid);
+		if (!sid.empty())
+		{
+			sids.push_back(sid);
+		}
+	}
+	string result;
+	append_int(result, sids.size());
+	for (auto &sid : sids)
+	{
+		auto parts = StringUtil::Split(sid, ":");
+		auto uuid = StringUtil::Replace(parts[0], "-", "");
+		if (parts.size() < 2 || uuid.size() != 32)
+		{
+			throw InvalidInputException("Invalid GTID set \"%s\"", gtid_set);
+		}
+		for (idx_t i = 0; i < 16; i++)
+		{
+			result += (char)std::stoul(uuid.substr(2 * i, 2), nullptr, 16);
+		}
+		append_int(result, parts.size() - 1);
+		for (idx_t i = 1; i < parts.size(); i++)
+		{
+			// tagged GTIDs of MySQL 8.3 have a name here, they are not supported
+			auto bounds = StringUtil::Split(parts[i], "-");
+			if (bounds.empty() || bounds.size() > 2 || parts[i].find_first_not_of("0123456789-") != string::npos)
+			{
+				throw InvalidInputException("Invalid GTID interval \"%s\" in GTID set \"%s\"", parts[i], gtid_set);
+			}
+			auto start = std::stoull(bounds[0]);
+			auto end = bounds.size() == 2 ? std::stoull(bounds[1]) : start;
+			append_int(result, start);
+			append_int(result, end + 1);
+		}
+	}
+	return result;
+}
+
+static void MysqlBinlogFixGtidSet(MYSQL_RPL *rpl, unsigned char *packet_gtid_set)
+{
+	auto &encoded = *(string *)rpl->gtid_set_arg;
+	memcpy(packet_gtid_set, encoded.data(), encoded.size());
+}
+
+// Runs a query on the connection of the dump and returns the first row, an empty vector when there is none
+static vector<string> MysqlBinlogQueryRow(MYSQL *mysql, const string &sql)
+{
+	if (mysql_query(mysql, sql.c_str()) != 0)
+	{
+		throw IOException("Unable to execute MySQL query: %s", mysql_error(mysql));
+	}
+	auto res = mysql_store_result(mysql);
+	vector<string> result;
+	if (!res)
+	{
+		if (mysql_field_count(mysql) != 0)
+		{
+			throw IOException("Unable to read MySQL result: %s", mysql_error(mysql));
+		}
+		return result;
+	}
+	auto row = mysql_fetch_row(res);
+	if (row)
+	{
+		for (idx_t col_idx = 0; col_idx < mysql_num_fields(res); col_idx++)
+		{
+			result.push_back(row[col_idx] ? row[col_idx] : "");
+		}
+	}
+	mysql_free_result(res);
+	return result;
+}
+
+static unique_ptr<FunctionData> BinlogBind(ClientContext &context, TableFunctionBindInput &input,
+																					 vector<LogicalType> &return_types, vector<string> &names)
+{
+	auto result = make_uniq<BinlogFunctionData>();
+	result->host = input.inputs[0].GetValue<string>();
+	result->username = input.inputs[1].GetValue<string>();
+	result->password = input.inputs[2].GetValue<string>();
+	result->schema_name = input.inputs[3].GetValue<string>();
+	result->table_name = input.inputs[4].GetValue<string>();
+
+	for (auto &kv : input.named_parameters)
+	{
+		if (MysqlSetConnectionOption(result->connection_options, kv.first, kv.second))
+		{
+			continue;
+		}
+		if (kv.first == "binlog_file")
+		{
+			result->binlog_file = StringValue::Get(kv.second);
+		}
+		else if (kv.first == "binlog_position")
+		{
+			result->binlog_position = kv.second.GetValue<int64_t>();
+		}
+		else if (kv.first == "gtid_set")
+		{
+			result->gtid_set = StringValue::Get(kv.second);
+		}
+		else if (kv.first == "server_id")
+		{
+			result->server_id = kv.second.GetValue<int64_t>();
+		}
+	}
+	MysqlCheckConnectionOptions(result->connection_options);
+	if (!result->gtid_set.empty())
+	{
+		// fails early on a malformed set
+		MysqlBinlogEncodeGtidSet(result->gtid_set);
+	}
+
+	// the binlog only has the types of the columns, their names and the rest come from the table
+	auto pool = MySQLConnectionManager::getConnectionPool(1, 1, result->host, result->username, result->password,
+																												result->connection_options);
+	auto conn = pool->getConnection();
+	auto stmt = conn->createStatement();
+	auto res = stmt->executeQuery(StringUtil::Format(
+			"SELECT " MYSQL_COLUMN_INFO_SELECT ", c.COLUMN_TYPE FROM information_schema.columns c "
+			"WHERE c.table_schema = %s AND c.table_name = %s ORDER BY c.ordinal_position",
+			MysqlStringLiteral(result->schema_name), MysqlStringLiteral(result->table_name)));
+	MysqlTableMetadata metadata;
+	while (res->next())
+	{
+		auto info = ReadMysqlColumnInfo(res, 1);
+		AppendMysqlColumn(metadata, info);
+		auto column_type = StringUtil::Lower(res->getString(8).asStdString());
+		MysqlBinlogColumn column;
+		column.is_unsigned = StringUtil::Contains(column_type, "unsigned");
+		if (StringUtil::StartsWith(column_type, "set("))
+		{
+			// set('a','b') in the order of the bits of the values
+			auto members = res->getString(8).asStdString();
+			column.set_members = StringUtil::Split(members.substr(5, members.size() - 7), "','");
+		}
+		result->columns.push_back(std::move(column));
+	}
+	res->close();
+	delete res;
+	stmt->close();
+	delete stmt;
+	pool->releaseConnection(conn);
+	if (result->columns.empty())
+	{
+		throw InvalidInputException("Table %s.%s does not contain any columns OR does not exist in the DB.",
+																result->schema_name, result->table_name);
+	}
+
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("_binlog_file");
+	return_types.push_back(LogicalType::BIGINT);
+	names.emplace_back("_binlog_position");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("_gtid");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("_op");
+	result->row_types.push_back(LogicalType::VARCHAR);
+	for (idx_t col_idx = 0; col_idx < metadata.names.size(); col_idx++)
+	{
+		return_types.push_back(metadata.types[col_idx]);
+		names.push_back(metadata.names[col_idx]);
+		result->row_types.push_back(metadata.types[col_idx]);
+	}
+	return std::move(result);
+}
+
+// Connects as a replica and asks the server for its binlog from the requested position
+static unique_ptr<GlobalTableFunctionState> BinlogInitGlobalState(ClientContext &context, TableFunctionInitInput &input)
+{
+	auto &bind_data = (BinlogFunctionData &)*input.bind_data;
+	auto state = make_uniq<MysqlBinlogState>();
+	state->row_types = bind_data.row_types;
+	state->pending.Initialize(Allocator::DefaultAllocator(), state->row_types);
+	state->scan_chunk.Initialize(Allocator::DefaultAllocator(), state->row_types);
+	state->conn = make_uniq<NativeMysqlConnection>(bind_data.host, bind_data.username, bind_data.password,
+																								 bind_data.connection_options);
+	auto mysql = state->conn->get();
+
+	// the server only sends the checksums of the events to the replicas announcing they can check them
+	auto checksum = MysqlBinlogQueryRow(mysql, "SELECT @@global.binlog_checksum");
+	state->checksum = !checksum.empty() && StringUtil::Upper(checksum[0]) != "NONE";
+	MysqlBinlogQueryRow(mysql, "SET @master_binlog_checksum = @@global.binlog_checksum, "
+														 "@source_binlog_checksum = @@global.binlog_checksum");
+
+	state->file = bind_data.binlog_file;
+	state->position = bind_data.binlog_position;
+	if (state->file.empty() && bind_data.gtid_set.empty())
+	{
+		// the oldest binlog the server still has
+		auto oldest = MysqlBinlogQueryRow(mysql, "SHOW BINARY LOGS");
+		if (oldest.empty())
+		{
+			throw InvalidInputException("Binary logging is not enabled on %s", bind_data.host);
+		}
+		state->file = oldest[0];
+		state->position = 4;
+	}
+
+	memset(&state->rpl, 0, sizeof(state->rpl));
+	state->rpl.file_name = state->file.c_str();
+	state->rpl.file_name_length = state->file.size();
+	state->rpl.start_position = state->file.empty() ? 4 : state->position;
+	state->rpl.server_id = (unsigned int)bind_data.server_id;
+	state->rpl.flags = BINLOG_DUMP_NON_BLOCK | MYSQL_RPL_SKIP_HEARTBEAT;
+	if (!bind_data.gtid_set.empty())
+	{
+		state->encoded_gtid_set = MysqlBinlogEncodeGtidSet(bind_data.gtid_set);
+		state->rpl.flags |= MYSQL_RPL_GTID;
+		state->rpl.gtid_set_encoded_size = state->encoded_gtid_set.size();
+		state->rpl.fix_gtid_set = MysqlBinlogFixGtidSet;
+		state->rpl.gtid_set_arg = &state->encoded_gtid_set;
+	}
+	if (mysql_binlog_open(mysql, &state->rpl) != 0)
+	{
+		throw IOException("Unable to start reading the MySQL binlog: %s", mysql_error(mysql));
+	}
+	state->opened = true;
+	return std::move(state);
+}
+
+// Moves the pending rows to the rows of the transaction, the pending chunk being full or the transaction committed
+static void MysqlBinlogFlushPending(MysqlBinlogState &state)
+{
+	if (state.pending.size() == 0)
+	{
+		return;
+	}
+	if (!state.transaction_rows)
+	{
+		state.transaction_rows = make_uniq<ColumnDataCollection>(Allocator::DefaultAllocator(), state.row_types);
+	}
+	state.transaction_rows->Append(state.pending);
+	state.pending.Reset();
+}
+
+// The transaction committed: its rows can be returned, along with the position right after its commit
+static void MysqlBinlogCommit(MysqlBinlogState &state)
+{
+	MysqlBinlogFlushPending(state);
+	if (state.transaction_rows)
+	{
+		MysqlBinlogTransaction transaction;
+		transaction.rows = std::move(state.transaction_rows);
+		transaction.file = state.file;
+		transaction.position = state.position;
+		transaction.gtid = state.gtid;
+		state.ready.push_back(std::move(transaction));
+	}
+	state.gtid.clear();
+}
+
+static void MysqlBinlogRollback(MysqlBinlogState &state)
+{
+	state.pending.Reset();
+	state.transaction_rows.reset();
+	state.gtid.clear();
+}
+
+static void MysqlBinlogTableMap(const BinlogFunctionData &bind_data, MysqlBinlogState &state, MysqlBinlogReader &reader)
+{
+	auto table_id = reader.ReadLE(6);
+	reader.Skip(2);
+	auto schema_length = reader.ReadLE(1);
+	string schema_name(reader.ReadBytes(schema_length), schema_length);
+	reader.Skip(1);
+	auto table_length = reader.ReadLE(1);
+	string table_name(reader.ReadBytes(table_length), table_length);
+	reader.Skip(1);
+	if (schema_name != bind_data.schema_name || table_name != bind_data.table_name)
+	{
+		return;
+	}
+
+	auto column_count = reader.ReadPackedInt();
+	if (column_count != bind_data.columns.size())
+	{
+		// e.g. ALTER TABLE since the bind, the columns of the result would not match the rows anymore
+		throw InvalidInputException("Table %s.%s has %d columns in the binlog, %d when the query was bound",
+																schema_name, table_name, (int64_t)column_count, (int64_t)bind_data.columns.size());
+	}
+	auto types = (const uint8_t *)reader.ReadBytes(column_count);
+	reader.ReadPackedInt();
+	state.columns = bind_data.columns;
+	for (idx_t col_idx = 0; col_idx < column_count; col_idx++)
+	{
+		auto &column = state.columns[col_idx];
+		column.type = types[col_idx];
+		auto metadata_size = MysqlBinlogMetadataSize(column.type);
+		column.meta0 = metadata_size >= 1 ? (uint8_t)reader.ReadLE(1) : 0;
+		column.meta1 = metadata_size >= 2 ? (uint8_t)reader.ReadLE(1) : 0;
+	}
+	state.has_table = true;
+	state.table_id = table_id;
+}
+
+static void MysqlBinlogRows(MysqlBinlogState &state, MysqlBinlogEventType type, MysqlBinlogReader &reader)
+{
+	auto table_id = reader.ReadLE(6);
+	reader.Skip(2);
+	if (!state.has_table || table_id != state.table_id)
+	{
+		return;
+	}
+	if (type == MysqlBinlogEventType::WRITE_ROWS || type == MysqlBinlogEventType::UPDATE_ROWS ||
+			type == MysqlBinlogEventType::DELETE_ROWS)
+	{
+		// the length includes its own 2 bytes
+		auto extra_length = reader.ReadLE(2);
+		reader.Skip(extra_length - 2);
+	}
+	auto column_count = reader.ReadPackedInt();
+	auto before_present = MysqlBinlogReadBitmap(reader, column_count);
+	auto is_update = type == MysqlBinlogEventType::UPDATE_ROWS || type == MysqlBinlogEventType::UPDATE_ROWS_V1;
+	auto after_present = is_update ? MysqlBinlogReadBitmap(reader, column_count) : before_present;
+	if (column_count != state.columns.size())
+	{
+		throw InvalidInputException("Rows event with %d columns for a table of %d columns", (int64_t)column_count,
+																(int64_t)state.columns.size());
+	}
+
+	while (reader.Remaining() > 0)
+	{
+		if (is_update)
+		{
+			MysqlBinlogReadRow(reader, state.columns, before_present, "update_before", state.pending);
+			if (state.pending.size() == STANDARD_VECTOR_SIZE)
+			{
+				MysqlBinlogFlushPending(state);
+			}
+			MysqlBinlogReadRow(reader, state.columns, after_present, "update_after", state.pending);
+		}
+		else
+		{
+			auto is_insert = type == MysqlBinlogEventType::WRITE_ROWS || type == MysqlBinlogEventType::WRITE_ROWS_V1;
+			MysqlBinlogReadRow(reader, state.columns, before_present, is_insert ? "insert" : "delete", state.pending);
+		}
+		if (state.pending.size() == STANDARD_VECTOR_SIZE)
+		{
+			MysqlBinlogFlushPending(state);
+		}
+	}
+}
+
+// Reads and handles the next event of the dump. Returns false once the server reached the end of its binlog.
+static bool MysqlBinlogNextEvent(const BinlogFunctionData &bind_data, MysqlBinlogState &state)
+{
+	auto mysql = state.conn->get();
+	if (mysql_binlog_fetch(mysql, &state.rpl) != 0)
+	{
+		throw IOException("Unable to read the MySQL binlog: %s", mysql_error(mysql));
+	}
+	// the end of the dump
+	if (state.rpl.size == 0)
+	{
+		return false;
+	}
+	// the packet starts with the OK byte of the protocol
+	if (state.rpl.size < 1 + MYSQL_BINLOG_HEADER_SIZE)
+	{
+		throw IOException("Truncated MySQL binlog event");
+	}
+	MysqlBinlogReader header(state.rpl.buffer + 1, state.rpl.size - 1);
+	header.Skip(4);
+	auto type = (MysqlBinlogEventType)header.ReadLE(1);
+	header.Skip(4);
+	auto event_size = header.ReadLE(4);
+	auto log_pos = header.ReadLE(4);
+	if (event_size > header.size)
+	{
+		throw IOException("Truncated MySQL binlog event");
+	}
+	if (type == MysqlBinlogEventType::FORMAT_DESCRIPTION && event_size >= MYSQL_BINLOG_HEADER_SIZE + 5)
+	{
+		// the checksum algorithm is the byte before the checksum of the event itself, 1 for CRC32
+		state.checksum = header.data[event_size - MYSQL_BINLOG_CHECKSUM_SIZE - 1] == 1;
+	}
+	auto body_size = event_size - MYSQL_BINLOG_HEADER_SIZE - (state.checksum ? MYSQL_BINLOG_CHECKSUM_SIZE : 0);
+	MysqlBinlogReader body(header.data + MYSQL_BINLOG_HEADER_SIZE, body_size);
+	// 0 for the events the server makes up for the dump, which are not in the file
+	if (log_pos != 0)
+	{
+		state.position = log_pos;
+	}
+
+	switch (type)
+	{
+	case MysqlBinlogEventType::ROTATE:
+	{
+		auto position = body.ReadLE(8);
+		auto length = body.Remaining();
+		state.file = string(body.ReadBytes(length), length);
+		state.position = position;
+		break;
+	}
+	case MysqlBinlogEventType::GTID:
+	{
+		body.Skip(1);
+		auto sid = body.ReadBytes(16);
+		auto gno = (int64_t)body.ReadLE(8);
+		string uuid;
+		for (idx_t i = 0; i < 16; i++)
+		{
+			uuid += StringUtil::Format("%02x", (int)(uint8_t)sid[i]);
+			if (i == 3 || i == 5 || i == 7 || i == 9)
+			{
+				uuid += '-';
+			}
+		}
+		state.gtid = StringUtil::Format("%s:%d", uuid, gno);
+		break;
+	}
+	case MysqlBinlogEventType::QUERY:
+	{
+		body.Skip(8);
+		auto schema_length = body.ReadLE(1);
+		body.Skip(2);
+		auto status_length = body.ReadLE(2);
+		body.Skip(status_length + schema_length + 1);
+		auto length = body.Remaining();
+		auto query = StringUtil::Upper(string(body.ReadBytes(length), length));
+		StringUtil::Trim(query);
+		if (query == "COMMIT")
+		{
+			// transactions of non transactional tables end with a COMMIT query instead of a XID
+			MysqlBinlogCommit(state);
+		}
+		else if (query == "ROLLBACK")
+		{
+			MysqlBinlogRollback(state);
+		}
+		break;
+	}
+	case MysqlBinlogEventType::XID:
+		MysqlBinlogCommit(state);
+		break;
+	case MysqlBinlogEventType::TABLE_MAP:
+		MysqlBinlogTableMap(bind_data, state, body);
+		break;
+	case MysqlBinlogEventType::WRITE_ROWS_V1:
+	case MysqlBinlogEventType::UPDATE_ROWS_V1:
+	case MysqlBinlogEventType::DELETE_ROWS_V1:
+	case MysqlBinlogEventType::WRITE_ROWS:
+	case MysqlBinlogEventType::UPDATE_ROWS:
+	case MysqlBinlogEventType::DELETE_ROWS:
+		MysqlBinlogRows(state, type, body);
+		break;
+	case MysqlBinlogEventType::PARTIAL_UPDATE_ROWS:
+	{
+		auto table_id = body.ReadLE(6);
+		if (state.has_table && table_id == state.table_id)
+		{
+			throw NotImplementedException("Partial JSON updates (binlog_row_value_options=PARTIAL_JSON) are not supported");
+		}
+		break;
+	}
+	default:
+		break;
+	}
+	return true;
+}
+
+// Returns the rows of the committed transactions, reading the binlog until one is complete or the binlog ends
+static void BinlogFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+{
+	auto &bind_data = (BinlogFunctionData &)*data_p.bind_data;
+	auto &state = (MysqlBinlogState &)*data_p.global_state;
+	while (true)
+	{
+		if (!state.ready.empty())
+		{
+			auto &transaction = state.ready.front();
+			if (!state.scanning)
+			{
+				transaction.rows->InitializeScan(state.scan_state);
+				state.scanning = true;
+			}
+			if (!transaction.rows->Scan(state.scan_state, state.scan_chunk))
+			{
+				state.ready.pop_front();
+				state.scanning = false;
+				continue;
+			}
+			output.data[0].Reference(Value(transaction.file));
+			output.data[1].Reference(Value::BIGINT(transaction.position));
+			output.data[2].Reference(transaction.gtid.empty() ? Value(LogicalType::VARCHAR) : Value(transaction.gtid));
+			for (idx_t col_idx = 0; col_idx < state.scan_chunk.ColumnCount(); col_idx++)
+			{
+				output.data[MYSQL_BINLOG_TRANSACTION_COLUMNS + col_idx].Reference(state.scan_chunk.data[col_idx]);
+			}
+			output.SetCardinality(state.scan_chunk.size());
+			return;
+		}
+		if (state.finished)
+		{
+			output.SetCardinality(0);
+			return;
+		}
+		if (!MysqlBinlogNextEvent(bind_data, state))
+		{
+			// the rows of a transaction the binlog does not hold the commit of yet are not returned
+			spdlog::debug("end of the MySQL binlog at {}:{}", state.file, state.position);
+			state.finished = true;
+			mysql_binlog_close(state.conn->get(), &state.rpl);
+			state.opened = false;
+		}
+	}
+}
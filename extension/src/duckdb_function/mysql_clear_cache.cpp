@@ -0,0 +1,42 @@
+#include "duckdb.hpp"
+
+#include "../model/mysql_metadata_cache.hpp"
+
+using namespace duckdb;
+
+struct ClearCacheFunctionData : public TableFunctionData
+{
+	bool finished = false;
+	// only the tables of this host are dropped, every host when empty
+	string host;
+};
+
+static unique_ptr<FunctionData> ClearCacheBind(ClientContext &context, TableFunctionBindInput &input,
+																							 vector<LogicalType> &return_types, vector<string> &names)
+{
+	auto result = make_uniq<ClearCacheFunctionData>();
+	for (auto &kv : input.named_parameters)
+	{
+		if (kv.first == "host")
+		{
+			result->host = StringValue::Get(kv.second);
+		}
+	}
+
+	return_types.push_back(LogicalType::BOOLEAN);
+	names.emplace_back("Success");
+	return std::move(result);
+}
+
+static void ClearCacheFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+{
+	auto &data = (ClearCacheFunctionData &)*data_p.bind_data;
+	if (data.finished)
+	{
+		return;
+	}
+	MysqlMetadataCache::Get().Clear(data.host);
+	output.SetCardinality(1);
+	output.SetValue(0, 0, Value::BOOLEAN(true));
+	data.finished = true;
+}
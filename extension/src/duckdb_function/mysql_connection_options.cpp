@@ -0,0 +1,66 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "connection_options.hpp"
+
+using namespace duckdb;
+
+// Reads the connection options shared by mysql_scan, mysql_attach and ATTACH ... (TYPE mysql).
+// Returns false for the parameters that are not connection options.
+bool MysqlSetConnectionOption(ConnectionOptions &options, const string &name, const Value &value)
+{
+	auto option = StringUtil::Lower(name);
+	if (option == "compression")
+	{
+		auto compression = StringUtil::Lower(value.ToString());
+		if (compression == "none")
+		{
+			options.compression = string();
+		}
+		else if (compression == "zlib" || compression == "zstd")
+		{
+			options.compression = compression;
+		}
+		else
+		{
+			throw InvalidInputException("Unsupported compression \"%s\", expected one of: none, zlib, zstd", value.ToString());
+		}
+		return true;
+	}
+	if (option == "compression_level")
+	{
+		auto level = value.DefaultCastAs(LogicalType::BIGINT).GetValue<int64_t>();
+		if (level < 1 || level > 22)
+		{
+			throw InvalidInputException("compression_level must be between 1 and 22");
+		}
+		options.compressionLevel = (int)level;
+		return true;
+	}
+	return false;
+}
+
+// Checks the options once all of them are read, as they may be given in any order
+void MysqlCheckConnectionOptions(const ConnectionOptions &options)
+{
+	// only zstd has a level, the client library ignores it otherwise
+	if (options.compressionLevel != 0 && options.compression != "zstd")
+	{
+		throw InvalidInputException("compression_level requires compression 'zstd'");
+	}
+}
+
+// The named parameters of mysql_scan opening connections with the same options
+static named_parameter_map_t MysqlConnectionParameters(const ConnectionOptions &options)
+{
+	named_parameter_map_t parameters;
+	if (!options.compression.empty())
+	{
+		parameters["compression"] = Value(options.compression);
+	}
+	if (options.compressionLevel != 0)
+	{
+		parameters["compression_level"] = Value::BIGINT(options.compressionLevel);
+	}
+	return parameters;
+}
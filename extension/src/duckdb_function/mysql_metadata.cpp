@@ -0,0 +1,228 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "mysql_jdbc.h"
+#include "connection_pool.hpp"
+#include "../model/mysql_bind_data.hpp"
+#include "../model/mysql_metadata_cache.hpp"
+#include "../transformer/mysql_to_duckdb_result.cpp"
+#include "../transformer/duckdb_to_mysql_literal.cpp"
+
+#include <spdlog/spdlog.h>
+
+using namespace duckdb;
+
+// Columns of information_schema.columns describing a column, in the order ReadMysqlColumnInfo expects them
+#define MYSQL_COLUMN_INFO_SELECT                                                 \
+	"c.column_name, c.DATA_TYPE, c.character_maximum_length, c.numeric_precision, " \
+	"c.numeric_scale, IF(c.DATA_TYPE = 'enum', SUBSTRING(c.COLUMN_TYPE,5), NULL) enum_values, c.is_nullable"
+
+static MysqlColumnInfo ReadMysqlColumnInfo(sql::ResultSet *res, int first)
+{
+	MysqlColumnInfo info;
+	info.column_name = res->getString(first);
+	info.type_info.name = res->getString(first + 1);
+	info.type_info.char_max_length = res->getInt(first + 2);
+	info.type_info.numeric_precision = res->getInt(first + 3);
+	info.type_info.numeric_scale = res->getInt(first + 4);
+	info.type_info.enum_values = res->getString(first + 5);
+	info.type_info.is_nullable = res->getString(first + 6).asStdString() != "NO";
+	return info;
+}
+
+static void AppendMysqlColumn(MysqlTableMetadata &metadata, MysqlColumnInfo &info)
+{
+	metadata.names.push_back(info.column_name);
+
+	auto duckdb_type = DuckDBType(info);
+	// we cast unsupported types to varchar on read
+	auto col_needs_cast = duckdb_type == LogicalType::INVALID;
+	metadata.needs_cast.push_back(col_needs_cast);
+	if (!col_needs_cast)
+	{
+		metadata.types.push_back(std::move(duckdb_type));
+	}
+	else
+	{
+		metadata.types.push_back(LogicalType::VARCHAR);
+	}
+
+	metadata.columns.push_back(info);
+}
+
+// Whether a key column can be split into ranges of int64_t bounds
+static bool IsMysqlPartitionKeyType(const string &data_type_p, const string &column_type_p)
+{
+	auto data_type = StringUtil::Lower(data_type_p);
+	auto column_type = StringUtil::Lower(column_type_p);
+	auto is_integral = data_type == "tinyint" || data_type == "smallint" || data_type == "mediumint" ||
+										 data_type == "int" || data_type == "bigint";
+	// unsigned bigint keys may not fit the signed range bounds
+	auto fits_int64 = !(data_type == "bigint" && StringUtil::Contains(column_type, "unsigned"));
+	return is_integral && fits_int64;
+}
+
+void GetTableTypesInfos(ConnectionPool* connection_pool, std::string schema_name, std::string table_name, MysqlTableMetadata &metadata){
+
+	auto conn = connection_pool->getConnection();
+	auto stmt2 = conn->createStatement();
+	auto res2 = stmt2->executeQuery(StringUtil::Format(
+			R"(
+			SELECT )" MYSQL_COLUMN_INFO_SELECT R"(
+			FROM   information_schema.columns c
+			WHERE  c.table_schema = %s
+			AND 	 c.table_name = %s
+			ORDER BY c.ordinal_position;
+			)",
+			MysqlStringLiteral(schema_name), MysqlStringLiteral(table_name)));
+
+	// can't scan a table without columns (yes those exist)
+	if (res2->rowsCount() == 0)
+	{
+		throw InvalidInputException("Table %s.%s does not contain any columns OR does not exist in the DB.", schema_name, table_name);
+	}
+
+	// set the column types in a MysqlColumnInfo struct by iterating over the result set
+	while (res2->next())
+	{
+		auto info = ReadMysqlColumnInfo(res2, 1);
+		AppendMysqlColumn(metadata, info);
+	}
+	res2->close();
+	delete res2;
+	stmt2->close();
+	delete stmt2;
+
+	connection_pool->releaseConnection(conn);
+}
+
+// Reads the metadata of every table of a schema with a single query: the columns, the TABLE_ROWS estimate
+// and the primary key when it can partition a scan. The result is what a bind of each table would cache.
+// Tables without TABLE_ROWS (views) get an estimate of 0 rows rather than a COUNT(*), which may be a full
+// remote scan of a view: their scans then page through them until a page comes back short.
+std::map<string, MysqlTableMetadata> GetSchemaMetadata(ConnectionPool *connection_pool, const string &schema_name)
+{
+	std::map<string, MysqlTableMetadata> tables;
+	std::map<string, vector<string>> primary_keys;
+
+	auto conn = connection_pool->getConnection();
+	auto stmt = conn->createStatement();
+	auto res = stmt->executeQuery(StringUtil::Format(
+			R"(
+			SELECT c.table_name,
+						 )" MYSQL_COLUMN_INFO_SELECT R"(,
+						 c.column_type,
+						 c.column_key,
+						 t.table_rows,
+						 CONCAT(IFNULL(t.CREATE_TIME, ''), '|', IFNULL(t.UPDATE_TIME, '')) version
+			FROM   information_schema.columns c
+			JOIN   information_schema.tables t
+						 ON  t.table_schema = c.table_schema
+						 AND t.table_name = c.table_name
+			WHERE  c.table_schema = %s
+			ORDER BY c.table_name, c.ordinal_position;
+			)",
+			MysqlStringLiteral(schema_name)));
+
+	auto loaded_at = std::chrono::steady_clock::now();
+	while (res->next())
+	{
+		string table_name = res->getString(1);
+		auto &metadata = tables[table_name];
+		auto info = ReadMysqlColumnInfo(res, 2);
+		AppendMysqlColumn(metadata, info);
+
+		if (res->getString(10).asStdString() == "PRI")
+		{
+			auto &keys = primary_keys[table_name];
+			keys.push_back(IsMysqlPartitionKeyType(info.type_info.name, res->getString(9)) ? info.column_name : string());
+		}
+		metadata.row_estimates[MysqlEstimateMode::TABLE_ROWS] = res->isNull(11) ? 0 : res->getInt64(11);
+		metadata.version = res->getString(12);
+		metadata.loaded_at = loaded_at;
+	}
+	res->close();
+	delete res;
+	stmt->close();
+	delete stmt;
+	connection_pool->releaseConnection(conn);
+
+	for (auto &table : tables)
+	{
+		// same rule as the bind: a single integral column, primary keys are always NOT NULL
+		auto &keys = primary_keys[table.first];
+		table.second.partitions["PRIMARY"] = {keys.size() == 1 ? keys[0] : string()};
+	}
+	return tables;
+}
+
+// Seconds the metadata of a table is cached for, 0 disables the cache
+int64_t MysqlMetadataCacheTTL(ClientContext &context)
+{
+	Value ttl;
+	if (context.TryGetCurrentSetting("mysql_metadata_cache_ttl", ttl) && !ttl.IsNull())
+	{
+		return ttl.GetValue<int64_t>();
+	}
+	return 0;
+}
+
+static bool MysqlMetadataCacheValidate(ClientContext &context)
+{
+	Value validate;
+	if (context.TryGetCurrentSetting("mysql_metadata_cache_validate", validate) && !validate.IsNull())
+	{
+		return BooleanValue::Get(validate);
+	}
+	return false;
+}
+
+// CREATE_TIME changes with ALTER TABLE, UPDATE_TIME with writes (when the storage engine tracks it).
+// MySQL 8 serves them from a cache refreshed every information_schema_stats_expiry seconds, which
+// current_stats disables for the session so that the writes since the last refresh are seen, and restores it
+// before the connection goes back to the pool.
+// UPDATE_TIME has a one second resolution: recent, when given, tells whether it is within the last second,
+// in which case a later write may still leave the same version.
+static string GetTableVersion(ConnectionPool *connection_pool, std::string schema_name, std::string table_name,
+															bool current_stats = false, bool *recent = nullptr)
+{
+	auto conn = connection_pool->getConnection();
+	auto stmt = conn->createStatement();
+	auto stats_expiry_set = false;
+	if (current_stats)
+	{
+		try
+		{
+			stmt->execute("SET SESSION information_schema_stats_expiry = 0");
+			stats_expiry_set = true;
+		}
+		catch (sql::SQLException &e)
+		{
+			// MySQL 5.7 has no such cache
+			spdlog::debug("could not set information_schema_stats_expiry: {}", e.what());
+		}
+	}
+	auto res = stmt->executeQuery(StringUtil::Format(
+			R"(SELECT CONCAT(IFNULL(CREATE_TIME, ''), '|', IFNULL(UPDATE_TIME, '')), IFNULL(UPDATE_TIME >= NOW() - INTERVAL 1 SECOND, 0) FROM information_schema.tables WHERE table_schema = %s AND table_name = %s)",
+			MysqlStringLiteral(schema_name), MysqlStringLiteral(table_name)));
+	string version;
+	if (res->next())
+	{
+		version = res->getString(1);
+		if (recent)
+		{
+			*recent = res->getBoolean(2);
+		}
+	}
+	res->close();
+	delete res;
+	if (stats_expiry_set)
+	{
+		// the other lookups through this connection, e.g. the TABLE_ROWS estimates, keep reading the cached statistics
+		stmt->execute("SET SESSION information_schema_stats_expiry = DEFAULT");
+	}
+	stmt->close();
+	delete stmt;
+	connection_pool->releaseConnection(conn);
+	return version;
+}
@@ -0,0 +1,243 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "mysql_jdbc.h"
+#include "mysql_connection_manager.hpp"
+#include "../model/mysql_bind_data.hpp"
+#include "../state/mysql_global_state.hpp"
+#include "../state/mysql_local_state.hpp"
+#include "../state/mysql_result_cache.hpp"
+#include "../transformer/duckdb_to_mysql_request.cpp"
+#include "../transformer/mysql_to_duckdb_result.cpp"
+#include "mysql_metadata.cpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/common/types/uuid.hpp"
+
+#include <cstdio>
+#include <spdlog/spdlog.h>
+
+using namespace duckdb;
+
+// Directory the results of the scans are cached in, empty when the cache is disabled
+static string MysqlResultCacheDirectory(ClientContext &context)
+{
+	Value directory;
+	if (context.TryGetCurrentSetting("mysql_result_cache_directory", directory) && !directory.IsNull())
+	{
+		return directory.ToString();
+	}
+	return string();
+}
+
+static bool MysqlResultCacheChecksum(ClientContext &context)
+{
+	Value validate;
+	if (context.TryGetCurrentSetting("mysql_result_cache_validate", validate) && !validate.IsNull())
+	{
+		auto mode = StringUtil::Lower(validate.ToString());
+		if (mode == "checksum")
+		{
+			return true;
+		}
+		if (mode != "update_time")
+		{
+			throw InvalidInputException("Unsupported mysql_result_cache_validate \"%s\", expected one of: update_time, checksum",
+																	validate.ToString());
+		}
+	}
+	return false;
+}
+
+// Version of the MySQL table a cached result is valid for, empty when the writes to the table can not be detected
+static string MysqlResultCacheVersion(ConnectionPool *pool, const MysqlBindData &bind_data, bool checksum)
+{
+	if (!checksum)
+	{
+		// without UPDATE_TIME (e.g. InnoDB tables not written since the server started) nothing tells a change,
+		// nor does it when it is the current second: a write committed after the scan started may not change it
+		bool recent = false;
+		auto version = GetTableVersion(pool, bind_data.schema_name, bind_data.table_name, true, &recent);
+		return recent || StringUtil::EndsWith(version, "|") ? string() : version;
+	}
+	// computed by the server, no row is transferred
+	auto conn = pool->getConnection();
+	auto stmt = conn->createStatement();
+	auto res = stmt->executeQuery(StringUtil::Format("CHECKSUM TABLE %s.%s", MysqlIdentifier(bind_data.schema_name),
+																									 MysqlIdentifier(bind_data.table_name)));
+	string version;
+	if (res->next() && !res->isNull(2))
+	{
+		version = "checksum|" + res->getString(2).asStdString();
+	}
+	res->close();
+	delete res;
+	stmt->close();
+	delete stmt;
+	pool->releaseConnection(conn);
+	return version;
+}
+
+// The query that reads the whole result of the scan, with its projection, filters and pushed down operators
+static string MysqlResultCacheQuery(const MysqlBindData &bind_data, TableFunctionInitInput &input)
+{
+	MysqlLocalState key_state;
+	key_state.column_ids = input.column_ids;
+	key_state.filters = input.filters.get();
+	auto query = DuckDBToMySqlRequest(&bind_data, key_state);
+	if (bind_data.has_remote_limit)
+	{
+		auto order_by = bind_data.remote_order_by.empty() ? string() : " ORDER BY " + bind_data.remote_order_by;
+		query += StringUtil::Format("%s LIMIT %d", order_by, bind_data.remote_limit);
+	}
+	return query;
+}
+
+static string MysqlResultCachePath(const string &directory, const MysqlBindData &bind_data, const string &query)
+{
+	auto key = bind_data.host + "\n" + bind_data.username + "\n" + query;
+	char hash[17];
+	snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)Hash(key.c_str(), key.size()));
+	return FileSystem::CreateLocal()->JoinPath(directory, StringUtil::Format("mysql_%s.duckdb", hash));
+}
+
+// The cached result of the query if it is valid for the version of the table
+static unique_ptr<MysqlResultCacheReader> MysqlResultCacheLookup(const string &path, const string &query,
+																																 const string &version)
+{
+	auto fs = FileSystem::CreateLocal();
+	if (!fs->FileExists(path))
+	{
+		return nullptr;
+	}
+	auto reader = make_uniq<MysqlResultCacheReader>();
+	DBConfig config;
+	config.options.access_mode = AccessMode::READ_ONLY;
+	config.options.maximum_threads = 1;
+	try
+	{
+		reader->db = make_uniq<DuckDB>(path, &config);
+		reader->con = make_uniq<Connection>(*reader->db);
+		auto info = reader->con->Query("SELECT query, version FROM " MYSQL_RESULT_CACHE_INFO_TABLE);
+		if (info->HasError() || info->RowCount() != 1)
+		{
+			return nullptr;
+		}
+		// the query is compared as well, two queries may share a file name
+		if (info->GetValue(0, 0).ToString() != query || info->GetValue(1, 0).ToString() != version)
+		{
+			spdlog::debug("cached scan result {} is outdated", path);
+			return nullptr;
+		}
+		reader->result = reader->con->SendQuery("SELECT * FROM " MYSQL_RESULT_CACHE_ROWS_TABLE);
+		if (reader->result->HasError())
+		{
+			return nullptr;
+		}
+	}
+	catch (std::exception &e)
+	{
+		spdlog::warn("could not read the scan result cache {}: {}", path, e.what());
+		return nullptr;
+	}
+	return reader;
+}
+
+// A writer materializing the scan into a temporary file next to the cached result
+static unique_ptr<MysqlResultCacheWriter> MysqlResultCacheCreate(const string &path, const string &query,
+																																 const string &version, const vector<LogicalType> &types)
+{
+	auto writer = make_uniq<MysqlResultCacheWriter>();
+	writer->path = path;
+	writer->tmp_path = path + "." + StringUtil::Replace(UUID::ToString(UUID::GenerateRandomUUID()), "-", "") + ".tmp";
+	DBConfig config;
+	config.options.maximum_threads = 1;
+	try
+	{
+		auto fs = FileSystem::CreateLocal();
+		auto directory = path.substr(0, path.size() - fs->ExtractName(path).size());
+		if (!directory.empty() && !fs->DirectoryExists(directory))
+		{
+			fs->CreateDirectory(directory);
+		}
+		writer->db = make_uniq<DuckDB>(writer->tmp_path, &config);
+		writer->con = make_uniq<Connection>(*writer->db);
+		vector<string> columns;
+		for (idx_t col_idx = 0; col_idx < types.size(); col_idx++)
+		{
+			columns.push_back(StringUtil::Format("c%d %s", col_idx, types[col_idx].ToString()));
+		}
+		auto created = writer->con->Query(StringUtil::Format(
+				"CREATE TABLE " MYSQL_RESULT_CACHE_ROWS_TABLE " (%s); CREATE TABLE " MYSQL_RESULT_CACHE_INFO_TABLE
+				" (query VARCHAR, version VARCHAR)",
+				StringUtil::Join(columns, ", ")));
+		if (created->HasError())
+		{
+			// e.g. a type without a SQL name, the scan is not cached
+			spdlog::debug("scan result can not be cached: {}", created->GetError());
+			writer->failed = true;
+			return writer;
+		}
+		Appender info(*writer->con, MYSQL_RESULT_CACHE_INFO_TABLE);
+		info.AppendRow(Value(query), Value(version));
+		info.Close();
+		writer->appender = make_uniq<Appender>(*writer->con, MYSQL_RESULT_CACHE_ROWS_TABLE);
+	}
+	catch (std::exception &e)
+	{
+		spdlog::warn("could not create the scan result cache {}: {}", path, e.what());
+		writer->failed = true;
+	}
+	return writer;
+}
+
+// Serves the scan from the cache when it holds a valid result, otherwise sets up its materialization.
+// Returns true when the scan reads the cache.
+static bool MysqlResultCacheInit(ClientContext &context, const MysqlBindData &bind_data, TableFunctionInitInput &input,
+																 MysqlGlobalState &gstate)
+{
+	auto directory = MysqlResultCacheDirectory(context);
+	// a pushed down join reads several tables, the version of a single one can not tell whether it changed
+	if (directory.empty() || !bind_data.remote_from.empty())
+	{
+		return false;
+	}
+	auto pool = MySQLConnectionManager::getConnectionPool(1, bind_data.GetPoolSize(), bind_data.host, bind_data.username,
+																												bind_data.password, bind_data.connection_options);
+	auto version = MysqlResultCacheVersion(pool, bind_data, MysqlResultCacheChecksum(context));
+	if (version.empty())
+	{
+		return false;
+	}
+	auto query = MysqlResultCacheQuery(bind_data, input);
+	auto path = MysqlResultCachePath(directory, bind_data, query);
+
+	gstate.cache_reader = MysqlResultCacheLookup(path, query, version);
+	if (gstate.cache_reader)
+	{
+		spdlog::debug("reading scan result from {}", path);
+		gstate.max_threads = 1;
+		return true;
+	}
+	vector<LogicalType> types;
+	for (auto &reader : GetColumnReaders(bind_data, input.column_ids))
+	{
+		types.push_back(reader.type);
+	}
+	gstate.cache_writer = MysqlResultCacheCreate(path, query, version, types);
+	return false;
+}
+
+// Reads the next chunk of the cached result
+static void MysqlResultCacheScan(MysqlGlobalState &gstate, MysqlLocalState &lstate, DataChunk &output)
+{
+	auto &reader = *gstate.cache_reader;
+	lock_guard<mutex> guard(reader.lock);
+	lstate.cache_chunk = reader.result->Fetch();
+	if (!lstate.cache_chunk)
+	{
+		output.SetCardinality(0);
+		return;
+	}
+	output.Reference(*lstate.cache_chunk);
+}
@@ -1,17 +1,25 @@
+#pragma once
 #include "duckdb.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include <thread>
 #include <future>
 #include "mysql_connection_manager.hpp"
 
+#include "mysql_scan.hpp"
 #include "../model/mysql_bind_data.hpp"
+#include "../model/mysql_metadata_cache.hpp"
+#include "../model/mysql_scan_stats.hpp"
 #include "../state/mysql_local_state.hpp"
 #include "../state/mysql_global_state.hpp"
 #include "../transformer/duckdb_to_mysql_request.cpp"
 #include "../transformer/mysql_to_duckdb_result.cpp"
+#include "../transformer/mysql_binary_to_duckdb_result.cpp"
+#include "mysql_metadata.cpp"
+#include "mysql_connection_options.cpp"
+#include "mysql_result_cache.cpp"
 #include "../model/attach_function_data.cpp"
 #include <spdlog/spdlog.h>
 
-
 using namespace duckdb;
 
 static idx_t MysqlMaxThreads(ClientContext &context, const FunctionData *bind_data_p)
@@ -23,7 +31,7 @@ static idx_t MysqlMaxThreads(ClientContext &context, const FunctionData *bind_da
 	if (auto attach_data = dynamic_cast<const AttachFunctionData*>(bind_data_p)) {
 			bind_data = attach_data;
 	} else if (auto mysql_data = dynamic_cast<const MysqlBindData*>(bind_data_p)) {
-			bind_data = mysql_data;
+			return mysql_data->GetTaskCount();
 	} else {
 			//TODO handle the case when bind_data_p doesn't point to AttachFunctionData or MysqlBindData
 	}
@@ -31,94 +39,262 @@ static idx_t MysqlMaxThreads(ClientContext &context, const FunctionData *bind_da
 	return bind_data->get_approx_number_of_pages() / bind_data->get_pages_per_task();
 }
 
-static void MysqlInitPerTaskInternal(ClientContext &context, const MysqlBindData *bind_data_p,
-																		 MysqlLocalState &lstate, idx_t page_start_at, idx_t page_to_fetch)
+// Builds the predicate selecting the key range [lower, upper) of a range partitioned scan.
+// The first and the last ranges are left open so that rows written after the bind are still read.
+static string MysqlRangeFilter(const MysqlBindData &bind_data, int64_t lower, int64_t upper, bool first, bool last)
 {
-	D_ASSERT(bind_data_p);
+	auto column_name = MysqlIdentifier(bind_data.partition_column);
+	if (!bind_data.remote_alias.empty())
+	{
+		column_name = MysqlIdentifier(bind_data.remote_alias) + "." + column_name;
+	}
+	if (first && last)
+	{
+		return string();
+	}
+	if (first)
+	{
+		return StringUtil::Format("%s < %d", column_name, upper);
+	}
+	if (last)
+	{
+		return StringUtil::Format("%s >= %d", column_name, lower);
+	}
+	return StringUtil::Format("%s >= %d AND %s < %d", column_name, lower, column_name, upper);
+}
 
-	auto bind_data = (const MysqlBindData *)bind_data_p;
+// Takes the lock of the global state, counting the time spent waiting for it
+static unique_lock<mutex> MysqlLockGlobalState(MysqlGlobalState &gstate)
+{
+	unique_lock<mutex> guard(gstate.lock, std::try_to_lock);
+	if (!guard.owns_lock())
+	{
+		auto start = std::chrono::steady_clock::now();
+		guard.lock();
+		gstate.stats->lock_wait += MysqlScanStats::Micros(start);
+	}
+	return guard;
+}
 
-	// Queries like SELECT count(*) do not require actually returning the columns from the
-	// Mysql table, but only counting the row. In this case, we will be asked to return
-	// the 'rowid' special column here. It must be the only selected column. The corresponding
-	// deparsed query will be 'SELECT NULL'..Note that the user is not allowed to explicitly
-	// request the 'rowid' special column from a Mysql table in a SQL query.
-	// TODO check that it works on MySQL too
-	// bool have_rowid = false;
-	// for (idx_t i = 0; i < lstate.column_ids.size(); i++)
-	// {
-	// 	if (lstate.column_ids[i] == (column_t)-1)
-	// 	{
-	// 		have_rowid = true;
-	// 		break;
-	// 	}
-	// }
-
-	// if (have_rowid && lstate.column_ids.size() > 1)
-	// {
-	// 	throw InternalException("Cannot return ROW_ID from Mysql table");
-	// }
-
-	// if (have_rowid)
-	// {
-	// 	// We are only counting rows, not interested in the actual values of the columns.
-	// 	col_names = "NULL";
-	// }
-	// else
-	// {
-
-	lstate.base_sql = DuckDBToMySqlRequest(bind_data_p, lstate);
-
-	lstate.start_page = page_start_at;
-	lstate.end_page = page_start_at + page_to_fetch;
-	lstate.pagesize = STANDARD_VECTOR_SIZE;
-
-	// spdlog::debug("lstate.start_page: " << lstate.start_page <<);
-	// spdlog::debug("lstate.end_page: " << lstate.end_page <<);
-
-	// spdlog::debug("BASE SQL: " << lstate.base_sql <<);
+// Claims the next task of the scan. The global lock only covers the assignment of the key range
+// or of the page, the queries are issued outside of it.
+static bool MysqlNextTask(const MysqlBindData &bind_data, MysqlGlobalState &gstate, MysqlTask &task)
+{
+	// spdlog::debug("MysqlNextTask: parallel_lock" <<);
+	auto parallel_lock = MysqlLockGlobalState(gstate);
 
-	lstate.exec = false;
-	lstate.done = false;
+	if (bind_data.has_remote_limit)
+	{
+		// the pushed down LIMIT is small enough to be read by a single query
+		if (gstate.offset_exhausted)
+		{
+			return false;
+		}
+		gstate.offset_exhausted = true;
+		auto order_by = bind_data.remote_order_by.empty() ? string() : "ORDER BY " + bind_data.remote_order_by + " ";
+		task.limit = StringUtil::Format("%sLIMIT %d", order_by, bind_data.remote_limit);
+		task.row_limit = 0;
+		return true;
+	}
 
-	lstate.stmt = lstate.conn->createStatement();
+	if (!bind_data.CanPage() && !bind_data.IsRangePartitioned())
+	{
+		// the groups or joined rows of the whole table are read by a single query
+		if (gstate.offset_exhausted)
+		{
+			return false;
+		}
+		gstate.offset_exhausted = true;
+		task.limit = string();
+		task.row_limit = 0;
+		return true;
+	}
+
+	if (bind_data.IsRangePartitioned())
+	{
+		if (gstate.ranges_exhausted)
+		{
+			return false;
+		}
+		auto lower = gstate.range_start;
+		auto first = lower == gstate.partition_min;
+		// compare in unsigned space so that the last range never overflows
+		auto remaining = (uint64_t)gstate.partition_max - (uint64_t)lower;
+		auto last = remaining < gstate.range_size;
+		auto upper = last ? gstate.partition_max : (int64_t)((uint64_t)lower + gstate.range_size);
+		gstate.range_start = upper;
+		gstate.ranges_exhausted = last;
+		task.filter = MysqlRangeFilter(bind_data, lower, upper, first, last);
+		task.row_limit = 0;
+		return true;
+	}
+
+	// the number of rows is an estimate: pages are handed out until a task comes back short
+	if (gstate.offset_exhausted)
+	{
+		return false;
+	}
+	auto rows_per_task = bind_data.GetRowsPerTask();
+	task.limit = StringUtil::Format("LIMIT %d OFFSET %d", rows_per_task, gstate.start_row);
+	task.row_limit = rows_per_task;
+	gstate.start_row += rows_per_task;
+	return true;
+}
 
-	auto sql = StringUtil::Format(
+static string MysqlTaskSql(const MysqlBindData &bind_data, MysqlLocalState &lstate, const MysqlTask &task)
+{
+	// no trailing semicolon: prepared statements of the native engine reject it
+	return StringUtil::Format(
 			R"(
-					%s LIMIT %d OFFSET %d;
+					%s %s
 				)",
-			lstate.base_sql, lstate.pagesize * lstate.end_page, lstate.start_page * lstate.current_page);
+			DuckDBToMySqlRequest(&bind_data, lstate, task.filter), task.limit);
+}
+
+static vector<LogicalType> MysqlColumnTypes(const MysqlLocalState &lstate)
+{
+	vector<LogicalType> types;
+	for (auto &reader : lstate.column_readers)
+	{
+		types.push_back(reader.type);
+	}
+	return types;
+}
+
+// Opens the connection of a slot the first time it is used, the slot then keeps it for the whole scan
+static void MysqlConnectSlot(const MysqlBindData &bind_data, MysqlScanStats &stats, MysqlTaskSlot &slot)
+{
+	if (bind_data.engine == MysqlScanEngine::NATIVE)
+	{
+		if (!slot.native_conn)
+		{
+			slot.native_conn = make_uniq<NativeMysqlConnection>(bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options);
+			stats.pool.creates++;
+		}
+		return;
+	}
+	if (!slot.conn)
+	{
+		slot.pool = MySQLConnectionManager::getConnectionPool(1, bind_data.GetPoolSize(), bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options);
+		slot.conn = slot.pool->getConnection(&stats.pool);
+	}
+}
 
+// Runs the query of a task on a slot, returns once MySQL starts sending the result
+static void MysqlExecuteTask(const MysqlBindData &bind_data, MysqlScanStats &stats, const vector<LogicalType> &types, MysqlTaskSlot &slot, const string &sql)
+{
 	spdlog::debug("running sql: {}", sql);
-	lstate.result_set = lstate.stmt->executeQuery(sql);
-	if (lstate.result_set->rowsCount() == 0)
-	{ // done here, lets try to get more
-		spdlog::debug("done reading, result set empty");
-		lstate.done = true;
+	MysqlConnectSlot(bind_data, stats, slot);
+	slot.closeResult();
+
+	stats.queries++;
+	auto start = std::chrono::steady_clock::now();
+	if (bind_data.engine == MysqlScanEngine::NATIVE)
+	{
+		MysqlNativeExecute(slot.native_result, slot.native_conn->get(), sql, types, bind_data.streaming);
+		stats.server_time += MysqlScanStats::Micros(start);
+		return;
 	}
+
+	slot.stmt = slot.conn->createStatement();
+	if (bind_data.streaming)
+	{
+		// forward only result sets are not buffered on the client: rows are read from the socket as the
+		// scan asks for them, which keeps the memory of a task bounded whatever its size
+		slot.stmt->setResultSetType(sql::ResultSet::TYPE_FORWARD_ONLY);
+	}
+	// an empty result set is detected by MysqlScan, which then moves on to the next task
+	slot.result_set = slot.stmt->executeQuery(sql);
+	stats.server_time += MysqlScanStats::Micros(start);
+}
+
+// Claims the task following the current one and starts its query in the background on the other slot,
+// so that the round trip to MySQL overlaps with the decoding of the current task.
+static void MysqlPrefetchNextTask(const MysqlBindData &bind_data, MysqlLocalState &lstate, MysqlGlobalState &gstate)
+{
+	MysqlTask task;
+	if (!bind_data.prefetch || !lstate.can_prefetch || !MysqlNextTask(bind_data, gstate, task))
+	{
+		return;
+	}
+	auto &slot = lstate.next();
+	slot.task_row_limit = task.row_limit;
+	auto sql = MysqlTaskSql(bind_data, lstate, task);
+	auto types = MysqlColumnTypes(lstate);
+	auto bind_data_p = &bind_data;
+	auto slot_p = &slot;
+	auto stats = gstate.stats;
+	slot.pending = std::async(std::launch::async, [bind_data_p, stats, types, slot_p, sql]()
+														{ MysqlExecuteTask(*bind_data_p, *stats, types, *slot_p, sql); });
+	lstate.prefetching = true;
 }
 
 static bool MysqlParallelStateNext(ClientContext &context, const FunctionData *bind_data_p,
 																	 MysqlLocalState &lstate, MysqlGlobalState &gstate)
 {
 	D_ASSERT(bind_data_p);
-	auto bind_data = (const MysqlBindData *)bind_data_p;
+	auto &bind_data = *(const MysqlBindData *)bind_data_p;
 
-	// spdlog::debug("MysqlParallelStateNext: parallel_lock" <<);
-	lock_guard<mutex> parallel_lock(gstate.lock);
-
-	// spdlog::debug("MysqlParallelStateNext: gstate.page_to_fetch: " << bind_data->approx_number_of_pages <<);
-	if (gstate.start_page < bind_data->approx_number_of_pages)
+	if (lstate.prefetching)
 	{
-		MysqlInitPerTaskInternal(context, bind_data, lstate, gstate.start_page, bind_data->approx_number_of_pages);
-		gstate.start_page += bind_data->pages_per_task;
-		return true;
+		// the task was claimed and queried while the previous one was decoded, rethrows its errors if any
+		lstate.current_slot = 1 - lstate.current_slot;
+		lstate.prefetching = false;
+		lstate.current().pending.get();
 	}
 	else
 	{
-		lstate.done = true;
-		return false;
+		MysqlTask task;
+		if (!MysqlNextTask(bind_data, gstate, task))
+		{
+			lstate.done = true;
+			if (gstate.cache_writer && !lstate.cache_finished)
+			{
+				lstate.cache_finished = true;
+				gstate.cache_writer->finished_workers++;
+			}
+			return false;
+		}
+		auto &slot = lstate.current();
+		slot.task_row_limit = task.row_limit;
+		MysqlExecuteTask(bind_data, *gstate.stats, MysqlColumnTypes(lstate), slot, MysqlTaskSql(bind_data, lstate, task));
 	}
+	gstate.stats->tasks++;
+
+	lstate.exec = false;
+	lstate.done = false;
+	lstate.task_row_count = 0;
+
+	MysqlPrefetchNextTask(bind_data, lstate, gstate);
+	return true;
+}
+
+static void MysqlPushdownComplexFilter(ClientContext &context, LogicalGet &get, FunctionData *bind_data_p,
+																			 vector<unique_ptr<Expression>> &filters)
+{
+	auto &bind_data = bind_data_p->Cast<MysqlBindData>();
+	for (auto &filter : filters)
+	{
+		string remote_filter;
+		if (!TransformExpression(get, bind_data, *filter, remote_filter))
+		{
+			continue;
+		}
+		// the filter stays in the plan, DuckDB applies it again to the rows MySQL returns
+		if (std::find(bind_data.remote_filters.begin(), bind_data.remote_filters.end(), remote_filter) ==
+				bind_data.remote_filters.end())
+		{
+			bind_data.remote_filters.push_back(remote_filter);
+		}
+	}
+}
+
+static unique_ptr<NodeStatistics> MysqlCardinality(ClientContext &context, const FunctionData *bind_data_p)
+{
+	D_ASSERT(bind_data_p);
+
+	auto bind_data = (const MysqlBindData *)bind_data_p;
+	return make_uniq<NodeStatistics>(bind_data->approx_number_of_rows);
 }
 
 static string MysqlScanToString(const FunctionData *bind_data_p)
@@ -131,12 +307,46 @@ static string MysqlScanToString(const FunctionData *bind_data_p)
 
 #define MYSQL_EPOCH_JDATE 2451545 /* == date2j(2000, 1, 1) */
 
+// Size of the values of a chunk: the width of the fixed size types, the length of the strings
+static idx_t MysqlChunkBytes(DataChunk &chunk)
+{
+	idx_t bytes = 0;
+	for (auto &vec : chunk.data)
+	{
+		auto physical_type = vec.GetType().InternalType();
+		if (physical_type != PhysicalType::VARCHAR)
+		{
+			bytes += GetTypeIdSize(physical_type) * chunk.size();
+			continue;
+		}
+		UnifiedVectorFormat format;
+		vec.ToUnifiedFormat(chunk.size(), format);
+		auto strings = (const string_t *)format.data;
+		for (idx_t row = 0; row < chunk.size(); row++)
+		{
+			auto idx = format.sel->get_index(row);
+			if (format.validity.RowIsValid(idx))
+			{
+				bytes += strings[idx].GetSize();
+			}
+		}
+	}
+	return bytes;
+}
+
 static void MysqlScan(ClientContext &context, TableFunctionInput &data, DataChunk &output)
 {
 	auto &bind_data = data.bind_data->Cast<MysqlBindData>();
 	auto &local_state = data.local_state->Cast<MysqlLocalState>();
 	auto &gstate = data.global_state->Cast<MysqlGlobalState>();
 
+	if (gstate.cache_reader)
+	{
+		MysqlResultCacheScan(gstate, local_state, output);
+		gstate.stats->RowsRead(output.size(), MysqlChunkBytes(output));
+		return;
+	}
+
 	while (true)
 	{
 		// spdlog::debug("while true..." <<);
@@ -149,58 +359,202 @@ static void MysqlScan(ClientContext &context, TableFunctionInput &data, DataChun
 		}
 
 		idx_t output_offset = 0;
+		auto column_count = output.ColumnCount();
+		auto &readers = local_state.column_readers;
+		auto decode_start = std::chrono::steady_clock::now();
+
+		if (bind_data.engine == MysqlScanEngine::NATIVE)
+		{
+			output_offset = MysqlNativeFetchChunk(local_state.current().native_result, readers, output);
+		}
 
 		// spdlog::debug("reading result set" <<);
 
 		// iterate over the result set and write the result in the output data chunk
-		while (local_state.result_set->next() && output_offset < STANDARD_VECTOR_SIZE)
+		while (bind_data.engine == MysqlScanEngine::JDBC && output_offset < STANDARD_VECTOR_SIZE && local_state.current().result_set->next())
 		{
 			// spdlog::debug("reading row: " << output_offset <<);
-			// for each column from the bind data, read the value and write it to the result vector
-			for (idx_t query_col_idx = 0; query_col_idx < output.ColumnCount(); query_col_idx++)
+			// for each projected column, decode the value with the decoder resolved at init and write it to the result vector
+			for (idx_t query_col_idx = 0; query_col_idx < column_count; query_col_idx++)
 			{
-				//spdlog::debug("ITERATE result set/ query_col_idx: " << query_col_idx << " output_offset: " << output_offset <<);
-				auto table_col_idx = local_state.column_ids[query_col_idx];
-				auto &out_vec = output.data[query_col_idx];
-				//spdlog::debug("bind_data.names[table_col_idx] " << bind_data.names[table_col_idx] <<);
-				//spdlog::debug("bind_data.types[table_col_idx] " << bind_data.types[table_col_idx].ToString() <<);
-				//spdlog::debug("bind_data.columns[table_col_idx].type_info " << bind_data.columns[table_col_idx].type_info.name <<);
-				//  print the size of output data
-				ProcessValue(local_state.result_set,
-										 bind_data.types[table_col_idx],
-										 &bind_data.columns[table_col_idx].type_info,
-										 out_vec,
-										 query_col_idx,
-										 output_offset);
+				auto &reader = readers[query_col_idx];
+				//  mysql column index starts from 1
+				reader.decode(local_state.current().result_set, reader, output.data[query_col_idx], query_col_idx + 1, output_offset);
 			}
 
 			output_offset++;
+		}
 
-			// spdlog::debug("Result set done, final output_offset " << output_offset <<);
+		// spdlog::debug("Result set done, final output_offset " << output_offset <<);
+		output.SetCardinality(output_offset);
+		local_state.task_row_count += output_offset;
+		gstate.stats->decode_time += MysqlScanStats::Micros(decode_start);
+		gstate.stats->RowsRead(output_offset, MysqlChunkBytes(output));
 
-			output.SetCardinality(output_offset);
+		if (output_offset < STANDARD_VECTOR_SIZE)
+		{
+			// the result set of the current task is exhausted, the next call picks up a new task
+			local_state.done = true;
+			auto task_row_limit = local_state.current().task_row_limit;
+			if (task_row_limit != 0 && local_state.task_row_count < task_row_limit)
+			{
+				// a short page means the end of the table was reached
+				gstate.offset_exhausted = true;
+			}
 		}
 
-		// spdlog::debug("output vector: " << output.size() <<);
-
-		//  spdlog::debug("local_state.current_page: " << local_state.current_page <<);
-		local_state.current_page += 1;
+		if (output_offset == 0)
+		{
+			// an empty task (e.g. a key range without rows) should not end the scan
+			continue;
+		}
 
-		if (local_state.current_page == local_state.end_page)
+		if (gstate.cache_writer)
 		{
-			// spdlog::debug("current = end => done" <<);
-			local_state.done = true;
+			gstate.cache_writer->append(output);
 		}
+		return;
+	}
+}
+
+// Reads the bounds of the partition key among the rows selected by filters, returns false and leaves them
+// untouched when there are no such rows
+static bool GetPartitionBounds(ConnectionPool *connection_pool, const MysqlBindData &bind_data, int64_t &partition_min, int64_t &partition_max,
+															 const vector<string> &filters = vector<string>(), ConnectionPoolStats *pool_stats = nullptr)
+{
+	auto conn = connection_pool->getConnection(pool_stats);
+	auto stmt = conn->createStatement();
+	auto where = filters.empty() ? string() : " WHERE " + StringUtil::Join(filters, " AND ");
+	auto bounds = stmt->executeQuery(StringUtil::Format(
+			R"(SELECT MIN(`%s`), MAX(`%s`) FROM `%s`.`%s`%s)",
+			bind_data.partition_column, bind_data.partition_column, bind_data.schema_name, bind_data.table_name, where));
+	auto found = false;
+	if (bounds->next() && !bounds->isNull(1))
+	{
+		partition_min = bounds->getInt64(1);
+		partition_max = bounds->getInt64(2);
+		found = true;
+	}
+	bounds->close();
+	delete bounds;
+	stmt->close();
+	delete stmt;
+	connection_pool->releaseConnection(conn);
+	return found;
+}
 
+// Opens the connections the workers of the scan will use in parallel up front, so that workers
+// starting after the first one do not pay a handshake in the middle of the scan
+static void MysqlWarmUp(ClientContext &context, const MysqlBindData &bind_data, MysqlGlobalState &gstate)
+{
+	auto workers = MinValue<idx_t>(TaskScheduler::GetScheduler(context).NumberOfThreads(), gstate.max_threads);
+	auto connection_count = workers * (bind_data.prefetch ? 2 : 1);
+	if (bind_data.engine == MysqlScanEngine::NATIVE)
+	{
+		vector<std::future<unique_ptr<NativeMysqlConnection>>> futures;
+		for (idx_t i = 0; i < connection_count; i++)
+		{
+			futures.push_back(std::async(std::launch::async, [&bind_data]()
+																	 { return make_uniq<NativeMysqlConnection>(bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options); }));
+		}
+		for (auto &future : futures)
+		{
+			try
+			{
+				gstate.native_connections.push_back(future.get());
+				gstate.stats->pool.creates++;
+			}
+			catch (std::exception &e)
+			{
+				// the worker opens its own connection later on and reports the error then
+				spdlog::warn("Unable to open native connection ahead of the scan: {}", e.what());
+			}
+		}
 		return;
 	}
+	// one more connection than the workers need is kept for the metadata queries of the next bind
+	auto pool = MySQLConnectionManager::getConnectionPool(1, bind_data.GetPoolSize(), bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options);
+	pool->warmUp(connection_count + 1, &gstate.stats->pool);
+}
+
+// Gives every slot of a worker its connection once, the worker then keeps it for all the tasks it pulls,
+// so no connection changes hands between threads while the scan runs.
+// The pool of a server is shared by its concurrent scans, so the prefetch slot does not wait for a connection:
+// the worker runs without prefetching when none is left.
+static void MysqlAcquireConnections(const MysqlBindData &bind_data, MysqlGlobalState &gstate, MysqlLocalState &lstate)
+{
+	idx_t slot_count = bind_data.prefetch ? 2 : 1;
+	for (idx_t slot_idx = 0; slot_idx < slot_count; slot_idx++)
+	{
+		auto &slot = lstate.slots[slot_idx];
+		if (bind_data.engine == MysqlScanEngine::NATIVE)
+		{
+			auto guard = MysqlLockGlobalState(gstate);
+			if (!gstate.native_connections.empty())
+			{
+				slot.native_conn = std::move(gstate.native_connections.back());
+				gstate.native_connections.pop_back();
+			}
+			continue;
+		}
+		if (slot_idx > 0)
+		{
+			slot.pool = MySQLConnectionManager::getConnectionPool(1, bind_data.GetPoolSize(), bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options);
+			slot.conn = slot.pool->tryGetConnection(&gstate.stats->pool);
+			if (!slot.conn)
+			{
+				spdlog::debug("no connection left in the pool to prefetch the tasks of a worker");
+				lstate.can_prefetch = false;
+			}
+			continue;
+		}
+		MysqlConnectSlot(bind_data, *gstate.stats, slot);
+	}
 }
 
 static unique_ptr<GlobalTableFunctionState> MysqlInitGlobalState(ClientContext &context,
 																																 TableFunctionInitInput &input)
 {
-	return make_uniq<MysqlGlobalState>(
+	auto gstate = make_uniq<MysqlGlobalState>(
 			MysqlMaxThreads(context, input.bind_data.get()));
+
+	auto bind_data = dynamic_cast<const MysqlBindData *>(input.bind_data.get());
+	// only the scans are listed by mysql_scan_stats(), not mysql_attach
+	gstate->stats = bind_data ? MysqlScanStatsRegistry::Get().Register(bind_data->host, bind_data->schema_name, bind_data->table_name,
+																																		 bind_data->engine == MysqlScanEngine::NATIVE ? "native" : "jdbc")
+														: make_shared<MysqlScanStats>();
+	if (bind_data && MysqlResultCacheInit(context, *bind_data, input, *gstate))
+	{
+		// served from the local cache, no connection is needed
+		gstate->stats->from_cache = true;
+		return std::move(gstate);
+	}
+	if (bind_data)
+	{
+		MysqlWarmUp(context, *bind_data, *gstate);
+	}
+	if (bind_data && bind_data->IsRangePartitioned() && !bind_data->has_remote_limit)
+	{
+		// the bounds are read when the scan starts rather than at bind time, so that binding a table
+		// whose partition key is cached needs no query; an empty table leaves them at 0 and runs a single task
+		// the ranges only cover the rows the filters select, e.g. the rows past a watermark split over all the tasks
+		MysqlLocalState filter_state;
+		filter_state.column_ids = input.column_ids;
+		filter_state.filters = input.filters.get();
+		auto filters = bind_data->remote_from.empty() ? MysqlFilterEntries(*bind_data, filter_state) : vector<string>();
+		auto pool = MySQLConnectionManager::getConnectionPool(1, bind_data->GetPoolSize(), bind_data->host, bind_data->username, bind_data->password, bind_data->connection_options);
+		auto bounds_start = std::chrono::steady_clock::now();
+		GetPartitionBounds(pool, *bind_data, gstate->partition_min, gstate->partition_max, filters, &gstate->stats->pool);
+		gstate->stats->queries++;
+		gstate->stats->server_time += MysqlScanStats::Micros(bounds_start);
+
+		// spread the key space evenly over the tasks, rounding up so that the ranges cover it entirely
+		auto task_count = bind_data->GetTaskCount();
+		auto key_span = (uint64_t)gstate->partition_max - (uint64_t)gstate->partition_min + 1;
+		gstate->range_start = gstate->partition_min;
+		gstate->range_size = MaxValue<uint64_t>(key_span / task_count + (key_span % task_count != 0), 1);
+	}
+	return std::move(gstate);
 }
 
 static unique_ptr<LocalTableFunctionState> MysqlInitLocalState(ExecutionContext &context,
@@ -211,10 +565,18 @@ static unique_ptr<LocalTableFunctionState> MysqlInitLocalState(ExecutionContext
 	auto &gstate = global_state->Cast<MysqlGlobalState>();
 
 	auto local_state = make_uniq<MysqlLocalState>();
+	if (gstate.cache_reader)
+	{
+		return std::move(local_state);
+	}
+	if (gstate.cache_writer)
+	{
+		gstate.cache_writer->workers++;
+	}
 	local_state->column_ids = input.column_ids;
-	local_state->pool = MySQLConnectionManager::getConnectionPool(1, 5, bind_data.host, bind_data.username, bind_data.password);
-	local_state->conn = (local_state->pool)->getConnection();
+	local_state->column_readers = GetColumnReaders(bind_data, local_state->column_ids);
 	local_state->filters = input.filters.get();
+	MysqlAcquireConnections(bind_data, gstate, *local_state);
 
 	if (!MysqlParallelStateNext(context.client, input.bind_data.get(), *local_state, gstate))
 	{
@@ -223,101 +585,324 @@ static unique_ptr<LocalTableFunctionState> MysqlInitLocalState(ExecutionContext
 	return std::move(local_state);
 }
 
-static int64_t GetApproxNumberOfPageForTable(ConnectionPool* connection_pool, std::string schema_name, std::string table_name){
+static int64_t GetApproxNumberOfRowsForTable(ConnectionPool* connection_pool, std::string schema_name, std::string table_name, MysqlEstimateMode estimate){
 	auto conn = connection_pool->getConnection();
-	auto stmt1 = conn->createStatement();
-	int64_t approx_number_of_pages = 0;
+	unique_ptr<sql::Statement> stmt1;
+	unique_ptr<sql::ResultSet> res;
+	int64_t approx_number_of_rows = -1;
 
-	auto res1 = stmt1->executeQuery(
-			StringUtil::Format(
-					R"(SELECT CEIL(COUNT(*) / %d) FROM %s.%s)",
-					STANDARD_VECTOR_SIZE, schema_name, table_name));
-	if (res1->rowsCount() != 1)
+	// the pool is bounded: the connection goes back to it whatever fails
+	try
 	{
-		throw InvalidInputException("Mysql table \"%s\".\"%s\" not found", schema_name,
-																table_name);
+		stmt1.reset(conn->createStatement());
+		if (estimate == MysqlEstimateMode::TABLE_ROWS || estimate == MysqlEstimateMode::KEY_RANGE)
+		{
+			// statistics maintained by the storage engine, no table access
+			res.reset(stmt1->executeQuery(StringUtil::Format(
+					R"(SELECT TABLE_ROWS FROM information_schema.tables WHERE table_schema = %s AND table_name = %s)",
+					MysqlStringLiteral(schema_name), MysqlStringLiteral(table_name))));
+			if (!res->next())
+			{
+				throw InvalidInputException("Mysql table \"%s\".\"%s\" not found", schema_name,
+																		table_name);
+			}
+			// views have no statistics, they are counted instead
+			if (!res->isNull(1))
+			{
+				approx_number_of_rows = res->getInt64(1);
+			}
+			res->close();
+		}
+		else if (estimate == MysqlEstimateMode::EXPLAIN)
+		{
+			// the optimizer estimate of a full scan, also based on the index statistics
+			res.reset(stmt1->executeQuery(
+					StringUtil::Format("EXPLAIN SELECT * FROM %s.%s", MysqlIdentifier(schema_name), MysqlIdentifier(table_name))));
+			if (res->next() && !res->isNull("rows"))
+			{
+				approx_number_of_rows = res->getInt64("rows");
+			}
+			res->close();
+		}
+
+		if (approx_number_of_rows < 0)
+		{
+			res.reset(stmt1->executeQuery(
+					StringUtil::Format("SELECT COUNT(*) FROM %s.%s", MysqlIdentifier(schema_name), MysqlIdentifier(table_name))));
+			if (res->rowsCount() != 1)
+			{
+				throw InvalidInputException("Mysql table \"%s\".\"%s\" not found", schema_name,
+																		table_name);
+			}
+			if (res->next())
+			{
+				approx_number_of_rows = res->getInt64(1);
+			}
+			else
+			{
+				// Handle the case where no rows were returned
+				// or unable to move to the first row
+				throw InvalidInputException("Failed to fetch data from result set");
+			}
+			res->close();
+		}
+		stmt1->close();
 	}
-	if (res1->next())
+	catch (...)
 	{
-		approx_number_of_pages = res1->getInt64(1);
+		res.reset();
+		stmt1.reset();
+		connection_pool->releaseConnection(conn);
+		throw;
 	}
-	else
+
+	res.reset();
+	stmt1.reset();
+	connection_pool->releaseConnection(conn);
+	return approx_number_of_rows;
+}
+
+static idx_t GetAverageRowLength(ConnectionPool* connection_pool, std::string schema_name, std::string table_name){
+	auto conn = connection_pool->getConnection();
+	auto stmt = conn->createStatement();
+	idx_t avg_row_length = 0;
+
+	auto res = stmt->executeQuery(
+			StringUtil::Format(
+					R"(SELECT AVG_ROW_LENGTH FROM information_schema.tables WHERE table_schema = %s AND table_name = %s)",
+					MysqlStringLiteral(schema_name), MysqlStringLiteral(table_name)));
+	if (res->next() && !res->isNull(1))
 	{
-		// Handle the case where no rows were returned
-		// or unable to move to the first row
-		throw InvalidInputException("Failed to fetch data from result set");
+		avg_row_length = res->getUInt64(1);
 	}
 
-	res1->close();
-	stmt1->close();
+	res->close();
+	delete res;
+	stmt->close();
+	delete stmt;
 	connection_pool->releaseConnection(conn);
-	return approx_number_of_pages;
+	return avg_row_length;
 }
 
-static std::tuple<vector<MysqlColumnInfo>, vector<string>, vector<LogicalType>, vector<bool>> GetTableTypesInfos(ConnectionPool* connection_pool, std::string schema_name, std::string table_name){
+static MysqlEstimateMode ParseEstimateMode(const string &value)
+{
+	auto mode = StringUtil::Lower(value);
+	if (mode == "count")
+	{
+		return MysqlEstimateMode::COUNT;
+	}
+	else if (mode == "table_rows")
+	{
+		return MysqlEstimateMode::TABLE_ROWS;
+	}
+	else if (mode == "explain")
+	{
+		return MysqlEstimateMode::EXPLAIN;
+	}
+	else if (mode == "key_range")
+	{
+		return MysqlEstimateMode::KEY_RANGE;
+	}
+	throw InvalidInputException("Unsupported estimate \"%s\", expected one of: count, table_rows, explain, key_range", value);
+}
 
-	vector<MysqlColumnInfo> columns;
-	vector<string> names;
-	vector<LogicalType> types;
-	vector<bool> needs_cast;
+static MysqlPartitionMode ParsePartitionMode(const string &value)
+{
+	auto mode = StringUtil::Lower(value);
+	if (mode == "auto")
+	{
+		return MysqlPartitionMode::AUTO;
+	}
+	else if (mode == "limit_offset")
+	{
+		return MysqlPartitionMode::LIMIT_OFFSET;
+	}
+	else if (mode == "primary_key")
+	{
+		return MysqlPartitionMode::PRIMARY_KEY;
+	}
+	throw InvalidInputException("Unsupported partitioning \"%s\", expected one of: auto, limit_offset, primary_key", value);
+}
 
+// Looks up the leading column of the partition index and its bounds. The index must be unique on a single
+// NOT NULL integral column so that [lower, upper) ranges split the table into disjoint tasks.
+// Returns false when the table has no such index.
+static bool GetPartitionColumn(ConnectionPool *connection_pool, MysqlBindData &bind_data)
+{
 	auto conn = connection_pool->getConnection();
-	auto stmt2 = conn->createStatement();
-	auto res2 = stmt2->executeQuery(StringUtil::Format(
+	auto stmt = conn->createStatement();
+	auto res = stmt->executeQuery(StringUtil::Format(
 			R"(
-			SELECT column_name,
-						 DATA_TYPE,
-       			 character_maximum_length,
-						 numeric_precision,
-						 numeric_scale,
-						 IF(DATA_TYPE = 'enum', SUBSTRING(COLUMN_TYPE,5), NULL) enum_values
-			FROM   information_schema.columns 
-			WHERE  table_schema = '%s'
-			AND 	 table_name = '%s';
+			SELECT s.column_name,
+						 c.data_type,
+						 c.column_type,
+						 (SELECT COUNT(*)
+							FROM   information_schema.statistics k
+							WHERE  k.table_schema = s.table_schema
+							AND    k.table_name = s.table_name
+							AND    k.index_name = s.index_name) key_parts
+			FROM   information_schema.statistics s
+			JOIN   information_schema.columns c
+						 ON  c.table_schema = s.table_schema
+						 AND c.table_name = s.table_name
+						 AND c.column_name = s.column_name
+			WHERE  s.table_schema = %s
+			AND    s.table_name = %s
+			AND    s.index_name = %s
+			AND    s.non_unique = 0
+			AND    s.seq_in_index = 1
+			AND    c.is_nullable = 'NO';
 			)",
-			schema_name, table_name));
+			MysqlStringLiteral(bind_data.schema_name), MysqlStringLiteral(bind_data.table_name),
+			MysqlStringLiteral(bind_data.partition_index)));
 
-	// can't scan a table without columns (yes those exist)
-	if (res2->rowsCount() == 0)
+	string column_name;
+	if (res->next())
 	{
-		throw InvalidInputException("Table %s.%s does not contain any columns OR does not exist in the DB.", schema_name, table_name);
+		auto key_parts = res->getInt64(4);
+		if (key_parts == 1 && IsMysqlPartitionKeyType(res->getString(2), res->getString(3)))
+		{
+			column_name = res->getString(1);
+		}
 	}
+	res->close();
+	delete res;
 
-	// set the column types in a MysqlColumnInfo struct by iterating over the result set
-	while (res2->next())
-	{
-		MysqlColumnInfo info;
-		info.column_name = res2->getString(1);
-		info.type_info.name = res2->getString(2);
-		info.type_info.char_max_length = res2->getInt(3);
-		info.type_info.numeric_precision = res2->getInt(4);
-		info.type_info.numeric_scale = res2->getInt(5);
-		info.type_info.enum_values = res2->getString(6);
+	bind_data.partition_column = column_name;
+	stmt->close();
+	delete stmt;
+	connection_pool->releaseConnection(conn);
+	return !column_name.empty();
+}
 
-		names.push_back(info.column_name);
+// Reads what the scan of a table needs to be planned: its columns, the number of rows and the partition key.
+// table_columns, when given, are the columns the table was resolved with by an attached catalog.
+void MysqlBindTable(ClientContext &context, MysqlBindData &bind_data, const MysqlTableMetadata *table_columns)
+{
+	bind_data.planned_threads = TaskScheduler::GetScheduler(context).NumberOfThreads();
 
-		auto duckdb_type = DuckDBType(info);
-		// we cast unsupported types to varchar on read
-		auto col_needs_cast = duckdb_type == LogicalType::INVALID;
-		needs_cast.push_back(col_needs_cast);
-		if (!col_needs_cast)
+	auto connection_pool = MySQLConnectionManager::getConnectionPool(1, bind_data.GetPoolSize(), bind_data.host, bind_data.username, bind_data.password, bind_data.connection_options);
+
+	// // Create threads for concurrent execution
+  //   std::thread t1(GetNumberOfShard, connection_pool, bind_data.get());
+  //   std::thread t2(GetTableTypesInfos, connection_pool, bind_data.get());
+
+  //   // Wait for both threads to finish
+  //   t1.join();
+  //   t2.join();
+	
+	auto ttl = MysqlMetadataCacheTTL(context);
+	MysqlTableMetadata metadata;
+	// the binds of the views mysql_attach creates use the metadata it read, whatever the TTL
+	auto seeded = MysqlMetadataCache::Get().LookupSeeded(bind_data.host, bind_data.username, bind_data.schema_name,
+																											 bind_data.table_name, metadata);
+	auto cached = seeded || (ttl > 0 && MysqlMetadataCache::Get().Lookup(bind_data.host, bind_data.username, bind_data.schema_name,
+																																			 bind_data.table_name, ttl, metadata));
+	if (!seeded && ttl > 0 && MysqlMetadataCacheValidate(context))
+	{
+		// a single cheap lookup tells whether the table changed since its metadata was cached
+		auto version = GetTableVersion(connection_pool, bind_data.schema_name, bind_data.table_name);
+		if (cached && version != metadata.version)
 		{
-			types.push_back(std::move(duckdb_type));
+			spdlog::debug("metadata of {}.{} is outdated", bind_data.schema_name, bind_data.table_name);
+			cached = false;
+			metadata = MysqlTableMetadata();
+		}
+		metadata.version = version;
+	}
+
+	auto row_estimate = metadata.row_estimates.find(bind_data.estimate);
+	auto has_row_estimate = row_estimate != metadata.row_estimates.end();
+	std::future<int64_t> fut;
+	if (!has_row_estimate)
+	{
+		spdlog::debug("GetApproxNumberOfRowsForTable");
+		fut = std::async (GetApproxNumberOfRowsForTable, connection_pool, bind_data.schema_name, bind_data.table_name, bind_data.estimate);
+	}
+	if (!cached)
+	{
+		if (table_columns)
+		{
+			metadata.columns = table_columns->columns;
+			metadata.names = table_columns->names;
+			metadata.types = table_columns->types;
+			metadata.needs_cast = table_columns->needs_cast;
 		}
 		else
 		{
-			types.push_back(LogicalType::VARCHAR);
+			spdlog::debug("GetTableTypesInfos");
+			GetTableTypesInfos(connection_pool, bind_data.schema_name, bind_data.table_name, metadata);
+			spdlog::debug("GetTableTypesInfos DONE");
 		}
+		metadata.loaded_at = std::chrono::steady_clock::now();
+	}
+	// the columns of a catalog entry stay those it was created with, whatever the cache holds now
+	auto &columns = table_columns ? *table_columns : metadata;
+	bind_data.columns = columns.columns;
+	bind_data.names = columns.names;
+	bind_data.types = columns.types;
+	bind_data.needs_cast = columns.needs_cast;
+
+	if (has_row_estimate)
+	{
+		bind_data.approx_number_of_rows = row_estimate->second;
+	}
+	else
+	{
+		auto nb_of_rows = fut.wait_until(std::chrono::system_clock::now() + std::chrono::seconds(30));
+		if (nb_of_rows == std::future_status::timeout)
+		{
+			throw std::runtime_error("Timeout while fetching number of rows");
+		} else {
+			bind_data.approx_number_of_rows = fut.get();
+		}
+		metadata.row_estimates[bind_data.estimate] = bind_data.approx_number_of_rows;
+		spdlog::debug("GetApproxNumberOfRowsForTable DONE");
+	}
 
-		columns.push_back(info);
+	if (!bind_data.streaming && bind_data.max_buffer_bytes != 0)
+	{
+		if (metadata.avg_row_length < 0)
+		{
+			metadata.avg_row_length = GetAverageRowLength(connection_pool, bind_data.schema_name, bind_data.table_name);
+		}
+		bind_data.avg_row_length = metadata.avg_row_length;
 	}
-	res2->close();
-	stmt2->close();
 
-	connection_pool->releaseConnection(conn);
+	if (bind_data.partitioning != MysqlPartitionMode::LIMIT_OFFSET)
+	{
+		auto partition = metadata.partitions.find(bind_data.partition_index);
+		if (partition == metadata.partitions.end())
+		{
+			GetPartitionColumn(connection_pool, bind_data);
+			metadata.partitions[bind_data.partition_index] = {bind_data.partition_column};
+		}
+		else
+		{
+			bind_data.partition_column = partition->second.column;
+		}
+		if (!bind_data.IsRangePartitioned() && bind_data.partitioning == MysqlPartitionMode::PRIMARY_KEY)
+		{
+			throw InvalidInputException("Mysql table \"%s\".\"%s\" has no unique index \"%s\" on a single integral NOT NULL column to partition on",
+																	bind_data.schema_name, bind_data.table_name, bind_data.partition_index);
+		}
+		spdlog::debug("partition column: {}", bind_data.partition_column);
+	}
 
-	return std::make_tuple(columns, names, types, needs_cast);
+	if (ttl > 0)
+	{
+		MysqlMetadataCache::Get().Store(bind_data.host, bind_data.username, bind_data.schema_name, bind_data.table_name, metadata);
+	}
 
+	if (bind_data.estimate == MysqlEstimateMode::KEY_RANGE && bind_data.IsRangePartitioned())
+	{
+		// keys are unique, the width of the key range bounds the number of rows
+		int64_t partition_min = 0;
+		int64_t partition_max = -1;
+		GetPartitionBounds(connection_pool, bind_data, partition_min, partition_max);
+		bind_data.approx_number_of_rows = (uint64_t)partition_max - (uint64_t)partition_min + 1;
+	}
+	bind_data.approx_number_of_pages = (bind_data.approx_number_of_rows + STANDARD_VECTOR_SIZE - 1) / STANDARD_VECTOR_SIZE;
 }
 
 static unique_ptr<FunctionData> MysqlBind(ClientContext &context, TableFunctionBindInput &input,
@@ -334,37 +919,69 @@ static unique_ptr<FunctionData> MysqlBind(ClientContext &context, TableFunctionB
 	bind_data->schema_name = input.inputs[3].GetValue<string>();
 	bind_data->table_name = input.inputs[4].GetValue<string>();
 
-	auto connection_pool = MySQLConnectionManager::getConnectionPool(1, 5, bind_data->host, bind_data->username, bind_data->password);
-
-	// // Create threads for concurrent execution
-  //   std::thread t1(GetNumberOfShard, connection_pool, bind_data.get());
-  //   std::thread t2(GetTableTypesInfos, connection_pool, bind_data.get());
-
-  //   // Wait for both threads to finish
-  //   t1.join();
-  //   t2.join();
-	
-	// print current time with milliseconds and append GetApproxNumberOfPageForTable
-	spdlog::debug("GetApproxNumberOfPageForTable");
-
-	//spdlog::debug("Current time: " << std::ctime(&result) << " GetApproxNumberOfPageForTable " << bind_data->table_name <<);
-
-	std::future<int64_t> fut = std::async (GetApproxNumberOfPageForTable, connection_pool, bind_data->schema_name, bind_data->table_name);
-	spdlog::debug("GetTableTypesInfos");
-	auto columns_tuple = GetTableTypesInfos(connection_pool, bind_data->schema_name, bind_data->table_name);
-	spdlog::debug("GetTableTypesInfos DONE");
-	bind_data->columns = std::get<0>(columns_tuple);
-	bind_data->names = std::get<1>(columns_tuple);
-	bind_data->types = std::get<2>(columns_tuple);
-	bind_data->needs_cast = std::get<3>(columns_tuple);
-	auto nb_of_pages = fut.wait_until(std::chrono::system_clock::now() + std::chrono::seconds(30));
-	if (nb_of_pages == std::future_status::timeout)
-	{
-		throw std::runtime_error("Timeout while fetching number of pages");
-	} else {
-		bind_data->approx_number_of_pages = fut.get();
+	for (auto &kv : input.named_parameters)
+	{
+		if (MysqlSetConnectionOption(bind_data->connection_options, kv.first, kv.second))
+		{
+			continue;
+		}
+		if (kv.first == "partitioning")
+		{
+			bind_data->partitioning = ParsePartitionMode(StringValue::Get(kv.second));
+		}
+		else if (kv.first == "partition_index")
+		{
+			bind_data->partition_index = StringValue::Get(kv.second);
+		}
+		else if (kv.first == "engine")
+		{
+			auto engine = StringUtil::Lower(StringValue::Get(kv.second));
+			if (engine == "jdbc")
+			{
+				bind_data->engine = MysqlScanEngine::JDBC;
+			}
+			else if (engine == "native")
+			{
+				bind_data->engine = MysqlScanEngine::NATIVE;
+			}
+			else
+			{
+				throw InvalidInputException("Unsupported engine \"%s\", expected one of: jdbc, native", StringValue::Get(kv.second));
+			}
+		}
+		else if (kv.first == "estimate")
+		{
+			bind_data->estimate = ParseEstimateMode(StringValue::Get(kv.second));
+		}
+		else if (kv.first == "prefetch")
+		{
+			bind_data->prefetch = BooleanValue::Get(kv.second);
+		}
+		else if (kv.first == "streaming")
+		{
+			bind_data->streaming = BooleanValue::Get(kv.second);
+		}
+		else if (kv.first == "rows_per_task")
+		{
+			auto rows_per_task = kv.second.GetValue<int64_t>();
+			if (rows_per_task <= 0)
+			{
+				throw InvalidInputException("rows_per_task must be a positive number of rows");
+			}
+			bind_data->rows_per_task = rows_per_task;
+		}
+		else if (kv.first == "max_buffer_bytes")
+		{
+			auto max_buffer_bytes = kv.second.GetValue<int64_t>();
+			if (max_buffer_bytes < 0)
+			{
+				throw InvalidInputException("max_buffer_bytes must be a positive number of bytes");
+			}
+			bind_data->max_buffer_bytes = max_buffer_bytes;
+		}
 	}
-	spdlog::debug("GetApproxNumberOfPageForTable DONE");
+	MysqlCheckConnectionOptions(bind_data->connection_options);
+	MysqlBindTable(context, *bind_data);
 
 	return_types = bind_data->types;
 	names = bind_data->names;
@@ -0,0 +1,29 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "connection_options.hpp"
+#include "connection_pool.hpp"
+#include "../model/mysql_bind_data.hpp"
+#include "../model/mysql_metadata_cache.hpp"
+
+#include <map>
+
+using namespace duckdb;
+
+// The scan functions are compiled with mysql_scanner_extension.cpp, which includes their sources.
+// These are the parts of them the attached catalog (storage/mysql_catalog.cpp) binds its tables with.
+
+void MysqlBindTable(ClientContext &context, MysqlBindData &bind_data, const MysqlTableMetadata *table_columns = nullptr);
+
+void GetTableTypesInfos(ConnectionPool *connection_pool, std::string schema_name, std::string table_name,
+												MysqlTableMetadata &metadata);
+
+std::map<string, MysqlTableMetadata> GetSchemaMetadata(ConnectionPool *connection_pool, const string &schema_name);
+
+int64_t MysqlMetadataCacheTTL(ClientContext &context);
+
+bool MysqlSetConnectionOption(ConnectionOptions &options, const string &name, const Value &value);
+
+void MysqlCheckConnectionOptions(const ConnectionOptions &options);
+
+string MysqlStringLiteral(const string &value);
@@ -0,0 +1,96 @@
+#include "duckdb.hpp"
+
+#include "../model/mysql_scan_stats.hpp"
+
+using namespace duckdb;
+
+// SELECT * FROM mysql_scan_stats()
+struct ScanStatsFunctionData : public TableFunctionData
+{
+	bool listed = false;
+	vector<shared_ptr<MysqlScanStats>> scans;
+	// next scan to return
+	idx_t offset = 0;
+};
+
+static unique_ptr<FunctionData> ScanStatsBind(ClientContext &context, TableFunctionBindInput &input,
+																							vector<LogicalType> &return_types, vector<string> &names)
+{
+	auto add_column = [&](const string &name, const LogicalType &type)
+	{
+		names.push_back(name);
+		return_types.push_back(type);
+	};
+	add_column("scan_id", LogicalType::BIGINT);
+	add_column("host", LogicalType::VARCHAR);
+	add_column("schema_name", LogicalType::VARCHAR);
+	add_column("table_name", LogicalType::VARCHAR);
+	add_column("engine", LogicalType::VARCHAR);
+	add_column("from_cache", LogicalType::BOOLEAN);
+	add_column("start_time", LogicalType::TIMESTAMP);
+	add_column("finished", LogicalType::BOOLEAN);
+	add_column("elapsed_ms", LogicalType::DOUBLE);
+	add_column("tasks", LogicalType::BIGINT);
+	add_column("queries", LogicalType::BIGINT);
+	add_column("rows", LogicalType::BIGINT);
+	add_column("bytes", LogicalType::BIGINT);
+	add_column("first_row_ms", LogicalType::DOUBLE);
+	add_column("server_ms", LogicalType::DOUBLE);
+	add_column("decode_ms", LogicalType::DOUBLE);
+	add_column("lock_wait_ms", LogicalType::DOUBLE);
+	add_column("pool_checkouts", LogicalType::BIGINT);
+	add_column("pool_creates", LogicalType::BIGINT);
+	add_column("pool_waits", LogicalType::BIGINT);
+	add_column("pool_wait_ms", LogicalType::DOUBLE);
+	return make_uniq<ScanStatsFunctionData>();
+}
+
+static Value ScanStatsMillis(uint64_t micros)
+{
+	return Value::DOUBLE((double)micros / Interval::MICROS_PER_MSEC);
+}
+
+// Lists the counters of the latest scans, the running ones included, oldest first
+static void ScanStatsFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+{
+	auto &data = (ScanStatsFunctionData &)*data_p.bind_data;
+	if (!data.listed)
+	{
+		data.scans = MysqlScanStatsRegistry::Get().Snapshot();
+		data.listed = true;
+	}
+	auto count = MinValue<idx_t>(data.scans.size() - data.offset, STANDARD_VECTOR_SIZE);
+	for (idx_t row = 0; row < count; row++)
+	{
+		auto &stats = *data.scans[data.offset + row];
+		auto first_row = stats.first_row.load();
+		vector<Value> values {
+				Value::BIGINT(stats.scan_id),
+				Value(stats.host),
+				Value(stats.schema_name),
+				Value(stats.table_name),
+				Value(stats.engine),
+				Value::BOOLEAN(stats.from_cache),
+				Value::TIMESTAMP(stats.start_time),
+				Value::BOOLEAN(stats.finished),
+				ScanStatsMillis(stats.Elapsed()),
+				Value::BIGINT(stats.tasks),
+				Value::BIGINT(stats.queries),
+				Value::BIGINT(stats.rows),
+				Value::BIGINT(stats.bytes),
+				first_row < 0 ? Value(LogicalType::DOUBLE) : ScanStatsMillis(first_row),
+				ScanStatsMillis(stats.server_time),
+				ScanStatsMillis(stats.decode_time),
+				ScanStatsMillis(stats.lock_wait),
+				Value::BIGINT(stats.pool.checkouts),
+				Value::BIGINT(stats.pool.creates),
+				Value::BIGINT(stats.pool.waits),
+				ScanStatsMillis(stats.pool.waitMicros)};
+		for (idx_t col_idx = 0; col_idx < values.size(); col_idx++)
+		{
+			output.SetValue(col_idx, row, values[col_idx]);
+		}
+	}
+	output.SetCardinality(count);
+	data.offset += count;
+}
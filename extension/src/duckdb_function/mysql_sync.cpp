@@ -0,0 +1,165 @@
+#include "duckdb.hpp"
+
+#include "mysql_connection_options.cpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/qualified_name.hpp"
+
+using namespace duckdb;
+
+// CALL mysql_sync('localhost', 'root', '', 'shop', 'events', 'events', 'id')
+struct SyncFunctionData : public TableFunctionData
+{
+	bool finished = false;
+
+	string host;
+	string username;
+	string password;
+	string schema_name;
+	string table_name;
+	// the DuckDB table the rows are synced into, created by the first run
+	string target;
+	// a column only growing with the writes to the table, an auto increment key or an update timestamp
+	string watermark_column;
+	// when set, rows of the target with the keys of a synced row are replaced by it
+	vector<string> key_columns;
+
+	ConnectionOptions connection_options;
+	string partition_index;
+};
+
+static unique_ptr<FunctionData> SyncBind(ClientContext &context, TableFunctionBindInput &input,
+																				 vector<LogicalType> &return_types, vector<string> &names)
+{
+	auto result = make_uniq<SyncFunctionData>();
+	result->host = input.inputs[0].GetValue<string>();
+	result->username = input.inputs[1].GetValue<string>();
+	result->password = input.inputs[2].GetValue<string>();
+	result->schema_name = input.inputs[3].GetValue<string>();
+	result->table_name = input.inputs[4].GetValue<string>();
+	result->target = input.inputs[5].GetValue<string>();
+	result->watermark_column = input.inputs[6].GetValue<string>();
+
+	for (auto &kv : input.named_parameters)
+	{
+		if (MysqlSetConnectionOption(result->connection_options, kv.first, kv.second))
+		{
+			continue;
+		}
+		if (kv.first == "key_columns")
+		{
+			for (auto &key_column : ListValue::GetChildren(kv.second))
+			{
+				result->key_columns.push_back(key_column.GetValue<string>());
+			}
+		}
+		else if (kv.first == "partition_index")
+		{
+			result->partition_index = StringValue::Get(kv.second);
+		}
+	}
+	MysqlCheckConnectionOptions(result->connection_options);
+
+	return_types.push_back(LogicalType::BIGINT);
+	names.emplace_back("Rows");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.emplace_back("Watermark");
+	return std::move(result);
+}
+
+// mysql_scan_pushdown(...) reading the MySQL table with the connection options of the sync
+static string SyncScanSql(const SyncFunctionData &data)
+{
+	auto parameters = MysqlConnectionParameters(data.connection_options);
+	if (!data.partition_index.empty())
+	{
+		parameters["partition_index"] = Value(data.partition_index);
+	}
+	auto sql = StringUtil::Format("mysql_scan_pushdown(%s, %s, %s, %s, %s", Value(data.host).ToSQLString(),
+																Value(data.username).ToSQLString(), Value(data.password).ToSQLString(),
+																Value(data.schema_name).ToSQLString(), Value(data.table_name).ToSQLString());
+	for (auto &parameter : parameters)
+	{
+		sql += StringUtil::Format(", %s=%s", parameter.first, parameter.second.ToSQLString());
+	}
+	return sql + ")";
+}
+
+static unique_ptr<MaterializedQueryResult> SyncQuery(Connection &con, const string &sql)
+{
+	auto result = con.Query(sql);
+	if (result->HasError())
+	{
+		result->ThrowError("mysql_sync: ");
+	}
+	return result;
+}
+
+// Copies the rows of the MySQL table written since the last run into the target. The watermark is the
+// largest value of the watermark column found in the target, so it stays right whatever happens to the target.
+static void SyncFunction(ClientContext &context, TableFunctionInput &data_p, DataChunk &output)
+{
+	auto &data = (SyncFunctionData &)*data_p.bind_data;
+	if (data.finished)
+	{
+		return;
+	}
+
+	auto watermark = KeywordHelper::WriteOptionallyQuoted(data.watermark_column);
+	auto scan = SyncScanSql(data);
+	auto qualified_name = QualifiedName::Parse(data.target);
+	auto target_schema = qualified_name.schema == INVALID_SCHEMA ? DEFAULT_SCHEMA : qualified_name.schema;
+
+	Connection con(DatabaseInstance::GetDatabase(context));
+	con.BeginTransaction();
+	try
+	{
+		idx_t row_count;
+		if (!con.TableInfo(target_schema, qualified_name.name))
+		{
+			// the first run copies the whole table, in parallel over its key ranges
+			auto created = SyncQuery(con, StringUtil::Format("CREATE TABLE %s AS SELECT * FROM %s", data.target, scan));
+			row_count = created->GetValue(0, 0).GetValue<int64_t>();
+		}
+		else
+		{
+			auto last = SyncQuery(con, StringUtil::Format("SELECT max(%s) FROM %s", watermark, data.target))->GetValue(0, 0);
+			// the filter is pushed down to MySQL, and the key ranges of the scan only cover the rows past the watermark.
+			// With keys, the rows of the last watermark value are read again, rows written within the same
+			// timestamp after the previous run are then not missed.
+			auto delta_filter = last.IsNull() ? string()
+																				: StringUtil::Format(" WHERE %s %s %s", watermark,
+																														 data.key_columns.empty() ? ">" : ">=", last.ToSQLString());
+			SyncQuery(con, StringUtil::Format("CREATE TEMPORARY TABLE __mysql_sync_delta AS SELECT * FROM %s%s", scan,
+																				delta_filter));
+			if (!data.key_columns.empty())
+			{
+				vector<string> conditions;
+				for (auto &key_column : data.key_columns)
+				{
+					auto key = KeywordHelper::WriteOptionallyQuoted(key_column);
+					conditions.push_back(StringUtil::Format("%s.%s = __mysql_sync_delta.%s", data.target, key, key));
+				}
+				SyncQuery(con, StringUtil::Format("DELETE FROM %s USING __mysql_sync_delta WHERE %s", data.target,
+																					StringUtil::Join(conditions, " AND ")));
+			}
+			auto inserted = SyncQuery(con, StringUtil::Format("INSERT INTO %s SELECT * FROM __mysql_sync_delta", data.target));
+			row_count = inserted->GetValue(0, 0).GetValue<int64_t>();
+			SyncQuery(con, "DROP TABLE __mysql_sync_delta");
+		}
+		auto next = SyncQuery(con, StringUtil::Format("SELECT max(%s)::VARCHAR FROM %s", watermark, data.target))->GetValue(0, 0);
+		con.Commit();
+
+		output.SetCardinality(1);
+		output.SetValue(0, 0, Value::BIGINT(row_count));
+		output.SetValue(1, 0, next);
+	}
+	catch (...)
+	{
+		if (con.HasActiveTransaction())
+		{
+			con.Rollback();
+		}
+		throw;
+	}
+	data.finished = true;
+}
@@ -2,6 +2,7 @@
 #include "duckdb.hpp"
 
 #include "paged_mysql_state.hpp"
+#include "connection_options.hpp"
 
 using namespace duckdb;
 
@@ -24,6 +25,8 @@ struct AttachFunctionData : public TableFunctionData, public PagedMysqlState
 	string host;
 	string username;
 	string password;
+	// passed on to the scans of the views
+	ConnectionOptions connection_options;
 
 public:
 	idx_t get_approx_number_of_pages() const override
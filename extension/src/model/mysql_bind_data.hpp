@@ -2,6 +2,7 @@
 
 #include "duckdb.hpp"
 #include "mysql_jdbc.h"
+#include "connection_options.hpp"
 #include "paged_mysql_state.hpp"
 
 using namespace duckdb;
@@ -13,6 +14,7 @@ struct MysqlTypeInfo
 	int64_t numeric_precision;
 	int64_t numeric_scale;
 	string enum_values;
+	bool is_nullable = true;
 };
 
 struct MysqlColumnInfo
@@ -21,6 +23,39 @@ struct MysqlColumnInfo
 	MysqlTypeInfo type_info;
 };
 
+// How the scan is split into tasks for the parallel workers
+enum class MysqlPartitionMode : uint8_t
+{
+	// use a primary key range when the table has a suitable one, LIMIT/OFFSET otherwise
+	AUTO,
+	// page through the table with LIMIT/OFFSET
+	LIMIT_OFFSET,
+	// split an integral unique key into contiguous [lower, upper) ranges
+	PRIMARY_KEY
+};
+
+// Source of the number of rows estimated at bind time
+enum class MysqlEstimateMode : uint8_t
+{
+	// SELECT COUNT(*), exact but scans the whole table or index
+	COUNT,
+	// information_schema.tables.TABLE_ROWS, maintained by the storage engine
+	TABLE_ROWS,
+	// the rows estimate of EXPLAIN SELECT *
+	EXPLAIN,
+	// MAX - MIN + 1 of the partition key, TABLE_ROWS when the scan is not range partitioned
+	KEY_RANGE
+};
+
+// Client library used to run the remote queries and decode their results
+enum class MysqlScanEngine : uint8_t
+{
+	// Connector/C++ (JDBC like) result sets, decoded cell by cell
+	JDBC,
+	// libmysqlclient prepared statements, decoded from the binary protocol into the vectors
+	NATIVE
+};
+
 struct MysqlBindData : public FunctionData, public PagedMysqlState
 {
 	~MysqlBindData()
@@ -30,6 +65,8 @@ struct MysqlBindData : public FunctionData, public PagedMysqlState
 	string host;
 	string username;
 	string password;
+	// compression of the connections, part of the key of their pool
+	ConnectionOptions connection_options;
 
 	string schema_name;
 	string table_name;
@@ -37,6 +74,50 @@ struct MysqlBindData : public FunctionData, public PagedMysqlState
 	idx_t approx_number_of_pages = 0;
 	idx_t pages_per_task = 1000;
 
+	MysqlEstimateMode estimate = MysqlEstimateMode::TABLE_ROWS;
+	idx_t approx_number_of_rows = 0;
+
+	MysqlPartitionMode partitioning = MysqlPartitionMode::AUTO;
+	// index used to split the scan into ranges, must be unique on a single integral NOT NULL column
+	string partition_index = "PRIMARY";
+	// column the ranges are computed on, empty when the scan is paged with LIMIT/OFFSET
+	string partition_column;
+
+	MysqlScanEngine engine = MysqlScanEngine::JDBC;
+
+	// query the next task of a worker while the current one is decoded
+	bool prefetch = true;
+
+	// read results unbuffered, rows are pulled from the server as the scan consumes them
+	bool streaming = true;
+	// number of rows of each task, i.e. the LIMIT of each remote query when the scan is paged, 0 to derive it
+	// from pages_per_task. The rows of a task are still streamed or buffered as a whole, see streaming.
+	idx_t rows_per_task = 0;
+	// upper bound of the memory held by the buffered result sets of a scan, 0 for no bound
+	idx_t max_buffer_bytes = 0;
+	// average row length reported by MySQL, used to size the buffered tasks
+	idx_t avg_row_length = 0;
+	// number of threads the scan is planned for
+	idx_t planned_threads = 1;
+
+	// LIMIT (and ORDER BY) pushed down by the optimizer extension, the scan then runs as a single task
+	bool has_remote_limit = false;
+	idx_t remote_limit = 0;
+	string remote_order_by;
+
+	// conditions added to the WHERE clause of every task on top of the table filters
+	vector<string> remote_filters;
+
+	// aggregate pushed down by the optimizer extension: the scan then returns one row per group (and per task),
+	// the columns below describe the partial aggregates and remote_expressions holds their SELECT list
+	bool has_remote_aggregate = false;
+	vector<string> remote_expressions;
+	string remote_group_by;
+
+	// FROM clause of a join pushed down by the optimizer extension, the scanned table is aliased remote_alias in it
+	string remote_from;
+	string remote_alias;
+
 	vector<MysqlColumnInfo> columns;
 	vector<string> names;
 	vector<LogicalType> types;
@@ -46,6 +127,48 @@ struct MysqlBindData : public FunctionData, public PagedMysqlState
 	bool in_recovery;
 
 public:
+	bool IsRangePartitioned() const
+	{
+		return !partition_column.empty();
+	}
+
+	// grouped and joined results have no stable order, they can't be paged with LIMIT/OFFSET
+	bool CanPage() const
+	{
+		return !has_remote_aggregate && remote_from.empty();
+	}
+
+	idx_t GetRowsPerTask() const
+	{
+		auto task_rows = rows_per_task != 0 ? rows_per_task : MaxValue<idx_t>(pages_per_task, 1) * STANDARD_VECTOR_SIZE;
+		if (!streaming && max_buffer_bytes != 0 && avg_row_length != 0)
+		{
+			// every thread holds one fully buffered task result per slot, two when the next task is prefetched
+			auto slots_per_thread = prefetch ? 2 : 1;
+			auto rows_in_budget = max_buffer_bytes / (avg_row_length * MaxValue<idx_t>(planned_threads, 1) * slots_per_thread);
+			task_rows = MinValue<idx_t>(task_rows, MaxValue<idx_t>(rows_in_budget, 1));
+		}
+		return task_rows;
+	}
+
+	idx_t GetTaskCount() const
+	{
+		if (has_remote_limit || (!CanPage() && !IsRangePartitioned()))
+		{
+			return 1;
+		}
+		auto approx_number_of_rows = approx_number_of_pages * STANDARD_VECTOR_SIZE;
+		auto rows_per_task = GetRowsPerTask();
+		return MaxValue<idx_t>((approx_number_of_rows + rows_per_task - 1) / rows_per_task, 1);
+	}
+
+	// connections a scan may hold at once: one per task slot of every thread, plus one for metadata queries
+	int GetPoolSize() const
+	{
+		auto slots_per_thread = prefetch ? 2 : 1;
+		return (int)(MaxValue<idx_t>(planned_threads, 1) * slots_per_thread + 1);
+	}
+
 	idx_t get_approx_number_of_pages() const override
 	{
 		return approx_number_of_pages;
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "mysql_bind_data.hpp"
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <tuple>
+
+using namespace duckdb;
+
+// Unique key the scan can be split on, as found by the bind. Its bounds are read when the scan starts.
+struct MysqlPartitionInfo
+{
+	// empty when the index is not suitable
+	string column;
+};
+
+// Everything the bind of mysql_scan reads from information_schema and the table statistics
+struct MysqlTableMetadata
+{
+	vector<MysqlColumnInfo> columns;
+	vector<string> names;
+	vector<LogicalType> types;
+	vector<bool> needs_cast;
+
+	// the pieces below are filled on the first bind that needs them
+	std::map<MysqlEstimateMode, int64_t> row_estimates;
+	// -1 until fetched
+	int64_t avg_row_length = -1;
+	// by index name
+	std::map<string, MysqlPartitionInfo> partitions;
+
+	// CREATE_TIME and UPDATE_TIME of the table when the entry was loaded
+	string version;
+	std::chrono::steady_clock::time_point loaded_at;
+};
+
+// Process wide cache of table metadata, shared by every database instance and connection
+class MysqlMetadataCache
+{
+private:
+	using key_t = std::tuple<string, string, string, string>;
+
+	std::map<key_t, MysqlTableMetadata> entries;
+	// metadata mysql_attach read for the binds of the views it creates, used whatever the TTL until they exist
+	std::map<key_t, MysqlTableMetadata> seeded;
+	std::mutex entriesMutex;
+
+public:
+	static MysqlMetadataCache &Get()
+	{
+		static MysqlMetadataCache cache;
+		return cache;
+	}
+
+	// Copies the entry of the table into metadata if it is younger than ttl_seconds
+	bool Lookup(const string &host, const string &username, const string &schema, const string &table,
+							int64_t ttl_seconds, MysqlTableMetadata &metadata)
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		auto entry = entries.find(std::make_tuple(host, username, schema, table));
+		if (entry == entries.end())
+		{
+			return false;
+		}
+		if (std::chrono::steady_clock::now() - entry->second.loaded_at > std::chrono::seconds(ttl_seconds))
+		{
+			entries.erase(entry);
+			return false;
+		}
+		metadata = entry->second;
+		return true;
+	}
+
+	void Store(const string &host, const string &username, const string &schema, const string &table,
+						 const MysqlTableMetadata &metadata)
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		entries[std::make_tuple(host, username, schema, table)] = metadata;
+	}
+
+	void Seed(const string &host, const string &username, const string &schema, const string &table,
+						const MysqlTableMetadata &metadata)
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		seeded[std::make_tuple(host, username, schema, table)] = metadata;
+	}
+
+	bool LookupSeeded(const string &host, const string &username, const string &schema, const string &table,
+										MysqlTableMetadata &metadata)
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		auto entry = seeded.find(std::make_tuple(host, username, schema, table));
+		if (entry == seeded.end())
+		{
+			return false;
+		}
+		metadata = entry->second;
+		return true;
+	}
+
+	void Unseed(const string &host, const string &username, const string &schema, const string &table)
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		seeded.erase(std::make_tuple(host, username, schema, table));
+	}
+
+	// Drops the entries of a host, of every host when it is empty
+	idx_t Clear(const string &host = string())
+	{
+		std::lock_guard<std::mutex> lock(entriesMutex);
+		idx_t cleared = 0;
+		for (auto entry = entries.begin(); entry != entries.end();)
+		{
+			if (host.empty() || std::get<0>(entry->first) == host)
+			{
+				entry = entries.erase(entry);
+				cleared++;
+			}
+			else
+			{
+				entry++;
+			}
+		}
+		return cleared;
+	}
+};
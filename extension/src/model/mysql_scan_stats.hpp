@@ -0,0 +1,118 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "connection_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+using namespace duckdb;
+
+// Number of scans mysql_scan_stats() reports on, the oldest ones are dropped first
+#define MYSQL_SCAN_STATS_HISTORY 256
+
+// Counters of one execution of a MySQL scan, updated by its workers as they go.
+// Times are in microseconds, summed over the workers.
+struct MysqlScanStats
+{
+	static uint64_t Micros(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	idx_t scan_id = 0;
+	string host;
+	string schema_name;
+	string table_name;
+	string engine;
+	timestamp_t start_time;
+	std::chrono::steady_clock::time_point started_at = std::chrono::steady_clock::now();
+
+	// set when the result was read from the local result cache, by the init of the scan while it may be listed
+	std::atomic<bool> from_cache{false};
+	std::atomic<bool> finished{false};
+	std::atomic<uint64_t> elapsed{0};
+
+	std::atomic<uint64_t> tasks{0};
+	std::atomic<uint64_t> queries{0};
+	std::atomic<uint64_t> rows{0};
+	// size of the values read, as decoded
+	std::atomic<uint64_t> bytes{0};
+	// time from the start of the scan to its first row, -1 until then
+	std::atomic<int64_t> first_row{-1};
+	// time of the queries until MySQL starts sending their result
+	std::atomic<uint64_t> server_time{0};
+	// time of the reading of the results into chunks, the network reads of the streamed results included
+	std::atomic<uint64_t> decode_time{0};
+	// time the workers waited for the lock of the global state
+	std::atomic<uint64_t> lock_wait{0};
+	// connections of the scan, the ones the native engine opens counted as creates
+	ConnectionPoolStats pool;
+
+	void RowsRead(idx_t count, idx_t byte_count)
+	{
+		if (count == 0)
+		{
+			return;
+		}
+		rows += count;
+		bytes += byte_count;
+		int64_t none = -1;
+		first_row.compare_exchange_strong(none, Micros(started_at));
+	}
+
+	void Finish()
+	{
+		elapsed = Micros(started_at);
+		finished = true;
+	}
+
+	uint64_t Elapsed() const
+	{
+		return finished ? elapsed.load() : Micros(started_at);
+	}
+};
+
+// Process wide history of the latest scans
+class MysqlScanStatsRegistry
+{
+private:
+	std::deque<shared_ptr<MysqlScanStats>> scans;
+	idx_t next_scan_id = 1;
+	std::mutex scansMutex;
+
+public:
+	static MysqlScanStatsRegistry &Get()
+	{
+		static MysqlScanStatsRegistry registry;
+		return registry;
+	}
+
+	shared_ptr<MysqlScanStats> Register(const string &host, const string &schema_name, const string &table_name,
+																			const string &engine)
+	{
+		auto stats = make_shared<MysqlScanStats>();
+		stats->host = host;
+		stats->schema_name = schema_name;
+		stats->table_name = table_name;
+		stats->engine = engine;
+		stats->start_time = Timestamp::GetCurrentTimestamp();
+		std::lock_guard<std::mutex> lock(scansMutex);
+		stats->scan_id = next_scan_id++;
+		scans.push_back(stats);
+		if (scans.size() > MYSQL_SCAN_STATS_HISTORY)
+		{
+			scans.pop_front();
+		}
+		return stats;
+	}
+
+	vector<shared_ptr<MysqlScanStats>> Snapshot()
+	{
+		std::lock_guard<std::mutex> lock(scansMutex);
+		return vector<shared_ptr<MysqlScanStats>>(scans.begin(), scans.end());
+	}
+};
@@ -0,0 +1,638 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "duckdb/catalog/catalog_entry/aggregate_function_catalog_entry.hpp"
+#include "duckdb/function/function_binder.hpp"
+#include "duckdb/optimizer/optimizer_extension.hpp"
+#include "duckdb/planner/expression/bound_aggregate_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/column_binding_map.hpp"
+#include "duckdb/planner/logical_operator_visitor.hpp"
+#include "duckdb/planner/operator/logical_aggregate.hpp"
+#include "duckdb/planner/operator/logical_comparison_join.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+#include "duckdb/planner/operator/logical_limit.hpp"
+#include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_top_n.hpp"
+
+#include "../model/mysql_bind_data.hpp"
+#include "../transformer/duckdb_to_mysql_literal.cpp"
+#include "../transformer/duckdb_to_mysql_request.cpp"
+
+using namespace duckdb;
+
+// Finds the mysql_scan below an operator, looking through the projections which keep the number of rows.
+// Anything else in between (filters, joins, aggregates) changes which rows a LIMIT keeps.
+static optional_ptr<LogicalGet> MysqlFindScan(LogicalOperator &op)
+{
+	auto current = &op;
+	while (current->type == LogicalOperatorType::LOGICAL_PROJECTION)
+	{
+		current = current->children[0].get();
+	}
+	if (current->type != LogicalOperatorType::LOGICAL_GET)
+	{
+		return nullptr;
+	}
+	auto &get = current->Cast<LogicalGet>();
+	if (!dynamic_cast<MysqlBindData *>(get.bind_data.get()))
+	{
+		return nullptr;
+	}
+	return &get;
+}
+
+// Resolves the scanned column an expression reads, through the projections between its operator and the scan
+static bool MysqlResolveColumn(LogicalOperator &op, LogicalGet &get, Expression &expr, column_t &column_id)
+{
+	if (expr.type != ExpressionType::BOUND_COLUMN_REF)
+	{
+		return false;
+	}
+	auto &colref = expr.Cast<BoundColumnRefExpression>();
+	if (op.type == LogicalOperatorType::LOGICAL_PROJECTION)
+	{
+		auto &projection = op.Cast<LogicalProjection>();
+		if (colref.binding.table_index != projection.table_index)
+		{
+			return false;
+		}
+		return MysqlResolveColumn(*op.children[0], get, *projection.expressions[colref.binding.column_index], column_id);
+	}
+	if (&op != &get || colref.binding.table_index != get.table_index)
+	{
+		return false;
+	}
+	auto index = colref.binding.column_index;
+	if (!get.projection_ids.empty())
+	{
+		index = get.projection_ids[index];
+	}
+	column_id = get.column_ids[index];
+	return true;
+}
+
+// Types MySQL orders and compares the same way DuckDB does. Strings are left out: their order and equality
+// depend on the collation.
+static bool MysqlSameOrder(const MysqlBindData &bind_data, column_t column_id)
+{
+	if (column_id == COLUMN_IDENTIFIER_ROW_ID || bind_data.needs_cast[column_id])
+	{
+		return false;
+	}
+	switch (bind_data.types[column_id].id())
+	{
+	case LogicalTypeId::BOOLEAN:
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::DECIMAL:
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Renders the table filters of a scan for the WHERE clause, for when the scan no longer returns the filtered
+// columns. With an alias the columns are qualified with it, for the tables of a join.
+static bool MysqlTransformTableFilters(LogicalGet &get, const MysqlBindData &bind_data, vector<string> &filters,
+																			 const string &alias = string())
+{
+	for (auto &entry : get.table_filters.filters)
+	{
+		auto column_id = get.column_ids[entry.first];
+		if (column_id == COLUMN_IDENTIFIER_ROW_ID)
+		{
+			return false;
+		}
+		auto column_name = MysqlColumnExpression(bind_data, column_id);
+		if (!alias.empty())
+		{
+			column_name = MysqlIdentifier(alias) + "." + column_name;
+		}
+		filters.push_back(TransformFilter(column_name, *entry.second));
+	}
+	return true;
+}
+
+// Makes the scan return the given remote SELECT list, in order
+static void MysqlSetRemoteColumns(LogicalGet &get, MysqlBindData &bind_data, const vector<string> &expressions,
+																	const vector<MysqlColumnInfo> &columns, const vector<LogicalType> &types)
+{
+	bind_data.remote_expressions = expressions;
+	bind_data.columns = columns;
+	bind_data.names = expressions;
+	bind_data.types = types;
+	bind_data.needs_cast.assign(expressions.size(), false);
+	get.names = expressions;
+	get.returned_types = types;
+	get.column_ids.clear();
+	for (idx_t i = 0; i < expressions.size(); i++)
+	{
+		get.column_ids.push_back(i);
+	}
+	get.projection_ids.clear();
+	get.table_filters.filters.clear();
+}
+
+// Detaches the scan found by MysqlFindScan, the projections above it go away with the columns they read
+static unique_ptr<LogicalOperator> MysqlTakeScan(unique_ptr<LogicalOperator> &op)
+{
+	auto scan = &op;
+	while ((*scan)->type == LogicalOperatorType::LOGICAL_PROJECTION)
+	{
+		scan = &(*scan)->children[0];
+	}
+	return std::move(*scan);
+}
+
+// Adds up the partial counts of the tasks. Unlike sum it stays a BIGINT, and gives 0 rather than NULL without rows.
+struct MysqlCountCombineOperation
+{
+	template <class STATE>
+	static void Initialize(STATE &state)
+	{
+		state = 0;
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void Operation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &)
+	{
+		state += input;
+	}
+
+	template <class INPUT_TYPE, class STATE, class OP>
+	static void ConstantOperation(STATE &state, const INPUT_TYPE &input, AggregateUnaryInput &, idx_t count)
+	{
+		state += input * (int64_t)count;
+	}
+
+	template <class STATE, class OP>
+	static void Combine(const STATE &source, STATE &target, AggregateInputData &)
+	{
+		target += source;
+	}
+
+	template <class T, class STATE>
+	static void Finalize(STATE &state, T &target, AggregateFinalizeData &)
+	{
+		target = state;
+	}
+
+	static bool IgnoreNull()
+	{
+		return true;
+	}
+};
+
+// Renders an aggregate MySQL computes the same way as DuckDB over the scanned columns. DISTINCT, FILTER and
+// ORDER BY are left to DuckDB, so are the casts DuckDB adds to the input of an aggregate.
+static bool MysqlTransformAggregate(LogicalOperator &child, LogicalGet &get, const MysqlBindData &bind_data,
+																		BoundAggregateExpression &aggregate, string &remote)
+{
+	if (aggregate.IsDistinct() || aggregate.filter || aggregate.order_bys)
+	{
+		return false;
+	}
+	auto &name = aggregate.function.name;
+	if (name == "count_star")
+	{
+		remote = "COUNT(*)";
+		return true;
+	}
+	column_t column_id;
+	if (aggregate.children.size() != 1 || !MysqlResolveColumn(child, get, *aggregate.children[0], column_id) ||
+			column_id == COLUMN_IDENTIFIER_ROW_ID)
+	{
+		return false;
+	}
+	auto column_name = MysqlColumnExpression(bind_data, column_id);
+	if (name == "count")
+	{
+		remote = "COUNT(" + column_name + ")";
+		return true;
+	}
+	if ((name == "min" || name == "max") && MysqlSameOrder(bind_data, column_id))
+	{
+		remote = StringUtil::Upper(name) + "(" + column_name + ")";
+		return true;
+	}
+	if (name == "sum" && !bind_data.needs_cast[column_id])
+	{
+		switch (bind_data.types[column_id].id())
+		{
+		case LogicalTypeId::SMALLINT:
+		case LogicalTypeId::INTEGER:
+		case LogicalTypeId::BIGINT:
+		case LogicalTypeId::DECIMAL:
+		case LogicalTypeId::DOUBLE:
+			// MySQL sums exact types as a DECIMAL, read back as the HUGEINT or DECIMAL(38) DuckDB sums into
+			remote = "SUM(" + column_name + ")";
+			return true;
+		default:
+			return false;
+		}
+	}
+	return false;
+}
+
+// Binds the aggregate combining the partial results of the tasks, of the same type as the original aggregate
+static unique_ptr<Expression> MysqlCombineAggregate(ClientContext &context, const BoundAggregateExpression &aggregate,
+																										unique_ptr<Expression> partial)
+{
+	vector<unique_ptr<Expression>> children;
+	children.push_back(std::move(partial));
+	auto &name = aggregate.function.name;
+	if (name == "count_star" || name == "count")
+	{
+		auto function = AggregateFunction::UnaryAggregate<int64_t, int64_t, int64_t, MysqlCountCombineOperation>(
+				LogicalType::BIGINT, LogicalType::BIGINT);
+		function.name = "sum";
+		return make_uniq<BoundAggregateExpression>(std::move(function), std::move(children), nullptr, nullptr,
+																							 AggregateType::NON_DISTINCT);
+	}
+	// sum, min and max combine their own partial results
+	auto &entry = Catalog::GetEntry<AggregateFunctionCatalogEntry>(context, SYSTEM_CATALOG, DEFAULT_SCHEMA, name);
+	auto function = entry.functions.GetFunctionByArguments(context, {children[0]->return_type});
+	FunctionBinder binder(context);
+	auto combined = binder.BindAggregateFunction(function, std::move(children), nullptr, AggregateType::NON_DISTINCT);
+	if (combined->return_type != aggregate.return_type)
+	{
+		return nullptr;
+	}
+	return std::move(combined);
+}
+
+// Sends an aggregate right above a scan to MySQL as a SELECT ... GROUP BY. Every task returns the partial
+// aggregates of its rows: a range partitioned scan keeps its parallel tasks, each grouping its own key range,
+// and the aggregate left in the plan combines the partial results. Scans paged with LIMIT/OFFSET run as
+// a single task, the groups of the whole table are then read at once.
+static bool MysqlPushdownAggregate(ClientContext &context, LogicalAggregate &aggregate)
+{
+	if (aggregate.grouping_sets.size() > 1 || !aggregate.grouping_functions.empty())
+	{
+		return false;
+	}
+	auto get = MysqlFindScan(*aggregate.children[0]);
+	if (!get)
+	{
+		return false;
+	}
+	auto &bind_data = get->bind_data->Cast<MysqlBindData>();
+	if (bind_data.has_remote_aggregate || bind_data.has_remote_limit)
+	{
+		return false;
+	}
+	auto &child = *aggregate.children[0];
+
+	// the groups come first in the remote SELECT list, the partial aggregates after them
+	vector<string> expressions;
+	vector<MysqlColumnInfo> columns;
+	vector<LogicalType> types;
+	vector<string> groups;
+	for (auto &group : aggregate.groups)
+	{
+		column_t column_id;
+		if (!MysqlResolveColumn(child, *get, *group, column_id) || !MysqlSameOrder(bind_data, column_id))
+		{
+			return false;
+		}
+		auto column_name = MysqlColumnExpression(bind_data, column_id);
+		groups.push_back(column_name);
+		expressions.push_back(column_name);
+		columns.push_back(bind_data.columns[column_id]);
+		types.push_back(bind_data.types[column_id]);
+	}
+	vector<unique_ptr<Expression>> combined;
+	for (auto &expression : aggregate.expressions)
+	{
+		if (expression->GetExpressionClass() != ExpressionClass::BOUND_AGGREGATE)
+		{
+			return false;
+		}
+		auto &bound_aggregate = expression->Cast<BoundAggregateExpression>();
+		string remote;
+		if (!MysqlTransformAggregate(child, *get, bind_data, bound_aggregate, remote))
+		{
+			return false;
+		}
+		auto partial = make_uniq<BoundColumnRefExpression>(bound_aggregate.return_type,
+																											 ColumnBinding(get->table_index, expressions.size()));
+		auto combine = MysqlCombineAggregate(context, bound_aggregate, std::move(partial));
+		if (!combine)
+		{
+			return false;
+		}
+		auto info = MysqlColumnInfo();
+		info.column_name = remote;
+		expressions.push_back(remote);
+		columns.push_back(info);
+		types.push_back(bound_aggregate.return_type);
+		combined.push_back(std::move(combine));
+	}
+
+	// the table filters are on the scanned columns, which the scan no longer returns: they move to the WHERE clause
+	vector<string> filters;
+	if (!MysqlTransformTableFilters(*get, bind_data, filters))
+	{
+		return false;
+	}
+	bind_data.remote_filters.insert(bind_data.remote_filters.end(), filters.begin(), filters.end());
+	bind_data.has_remote_aggregate = true;
+	bind_data.remote_group_by = StringUtil::Join(groups, ", ");
+	MysqlSetRemoteColumns(*get, bind_data, expressions, columns, types);
+
+	for (idx_t i = 0; i < aggregate.groups.size(); i++)
+	{
+		aggregate.groups[i] = make_uniq<BoundColumnRefExpression>(types[i], ColumnBinding(get->table_index, i));
+	}
+	aggregate.expressions = std::move(combined);
+	auto scan = MysqlTakeScan(aggregate.children[0]);
+	aggregate.children[0] = std::move(scan);
+	return true;
+}
+
+static void MysqlOptimizeAggregates(ClientContext &context, LogicalOperator &op)
+{
+	if (op.type == LogicalOperatorType::LOGICAL_AGGREGATE_AND_GROUP_BY)
+	{
+		MysqlPushdownAggregate(context, op.Cast<LogicalAggregate>());
+	}
+	for (auto &child : op.children)
+	{
+		MysqlOptimizeAggregates(context, *child);
+	}
+}
+
+static bool MysqlTransformOrders(LogicalTopN &top_n, LogicalGet &get, const MysqlBindData &bind_data, string &order_by)
+{
+	vector<string> entries;
+	for (auto &order : top_n.orders)
+	{
+		column_t column_id;
+		if (!MysqlResolveColumn(*top_n.children[0], get, *order.expression, column_id) ||
+				!MysqlSameOrder(bind_data, column_id))
+		{
+			return false;
+		}
+		auto column_name = MysqlColumnExpression(bind_data, column_id);
+		auto descending = order.type == OrderType::DESCENDING;
+		if (bind_data.columns[column_id].type_info.is_nullable)
+		{
+			// MySQL sorts NULLs as the smallest values, the placement DuckDB asked for is made explicit
+			auto nulls_first = order.null_order == OrderByNullType::NULLS_FIRST;
+			entries.push_back(StringUtil::Format("%s IS NULL %s", column_name, nulls_first ? "DESC" : "ASC"));
+		}
+		entries.push_back(StringUtil::Format("%s %s", column_name, descending ? "DESC" : "ASC"));
+	}
+	order_by = StringUtil::Join(entries, ", ");
+	return true;
+}
+
+// Sends the LIMIT of the operator to MySQL when the rows fit a single task. The DuckDB operator stays in the
+// plan, it still applies the OFFSET and, for a TopN, the final order.
+static void MysqlPushdownLimit(LogicalGet &get, idx_t row_count, const string &order_by)
+{
+	auto &bind_data = get.bind_data->Cast<MysqlBindData>();
+	if (row_count > bind_data.GetRowsPerTask())
+	{
+		// large limits keep the parallel scan
+		return;
+	}
+	bind_data.has_remote_limit = true;
+	bind_data.remote_limit = row_count;
+	bind_data.remote_order_by = order_by;
+}
+
+static void MysqlOptimizeLimits(LogicalOperator &op)
+{
+	if (op.type == LogicalOperatorType::LOGICAL_LIMIT)
+	{
+		auto &limit = op.Cast<LogicalLimit>();
+		auto get = MysqlFindScan(*op.children[0]);
+		if (get && !limit.limit && !limit.offset && limit.limit_val != NumericLimits<int64_t>::Maximum() &&
+				limit.limit_val >= 0 && limit.offset_val >= 0)
+		{
+			MysqlPushdownLimit(*get, limit.limit_val + limit.offset_val, string());
+		}
+	}
+	else if (op.type == LogicalOperatorType::LOGICAL_TOP_N)
+	{
+		auto &top_n = op.Cast<LogicalTopN>();
+		auto get = MysqlFindScan(*op.children[0]);
+		string order_by;
+		if (get && top_n.limit >= 0 && top_n.offset >= 0 &&
+				MysqlTransformOrders(top_n, *get, get->bind_data->Cast<MysqlBindData>(), order_by))
+		{
+			MysqlPushdownLimit(*get, top_n.limit + top_n.offset, order_by);
+		}
+	}
+	for (auto &child : op.children)
+	{
+		MysqlOptimizeLimits(*child);
+	}
+}
+
+// Whether a scan still reads its table as bound, without anything pushed down by the optimizer extension.
+// The complex filters pushed at bind time are left out too: they name the columns without a table alias.
+static bool MysqlIsPlainScan(const MysqlBindData &bind_data)
+{
+	return !bind_data.has_remote_aggregate && !bind_data.has_remote_limit && bind_data.remote_from.empty() &&
+				 bind_data.remote_filters.empty();
+}
+
+static string MysqlQualifiedColumn(const string &alias, const MysqlBindData &bind_data, column_t column_id)
+{
+	return MysqlIdentifier(alias) + "." + MysqlColumnExpression(bind_data, column_id);
+}
+
+// Sends an inner join of two scans of the same server (same host and credentials, which is the key of their
+// connection pool) to MySQL as a single query, along with the table filters and the columns it returns.
+// This only pays off when fewer rows come out of the join than go into it, as estimated by the join order
+// optimizer. The left scan becomes the scan of the join: it keeps its key range tasks when it has some,
+// otherwise the join is read with a single query. The bindings of the join are mapped to its columns.
+static bool MysqlPushdownJoin(ClientContext &context, LogicalComparisonJoin &join,
+															column_binding_map_t<ColumnBinding> &replacements)
+{
+	if (join.join_type != JoinType::INNER || join.conditions.empty() || !join.has_estimated_cardinality)
+	{
+		return false;
+	}
+	auto &left_child = *join.children[0];
+	auto &right_child = *join.children[1];
+	auto left_get = MysqlFindScan(left_child);
+	auto right_get = MysqlFindScan(right_child);
+	if (!left_get || !right_get)
+	{
+		return false;
+	}
+	auto &left_data = left_get->bind_data->Cast<MysqlBindData>();
+	auto &right_data = right_get->bind_data->Cast<MysqlBindData>();
+	if (left_data.host != right_data.host || left_data.username != right_data.username ||
+			left_data.password != right_data.password ||
+			left_data.connection_options.key() != right_data.connection_options.key() || !MysqlIsPlainScan(left_data) || !MysqlIsPlainScan(right_data))
+	{
+		return false;
+	}
+	auto input_rows = left_child.EstimateCardinality(context) + right_child.EstimateCardinality(context);
+	if (join.estimated_cardinality >= input_rows)
+	{
+		return false;
+	}
+
+	const string left_alias = "t0";
+	const string right_alias = "t1";
+	vector<string> conditions;
+	for (auto &condition : join.conditions)
+	{
+		column_t left_id, right_id;
+		if (!MysqlResolveColumn(left_child, *left_get, *condition.left, left_id) ||
+				!MysqlResolveColumn(right_child, *right_get, *condition.right, right_id))
+		{
+			return false;
+		}
+		// same types on both sides, DuckDB would have added a cast otherwise
+		if (!MysqlSameOrder(left_data, left_id) || !MysqlSameOrder(right_data, right_id) ||
+				left_data.types[left_id] != right_data.types[right_id])
+		{
+			return false;
+		}
+		string comparison;
+		switch (condition.comparison)
+		{
+		case ExpressionType::COMPARE_EQUAL:
+			comparison = "=";
+			break;
+		case ExpressionType::COMPARE_NOT_DISTINCT_FROM:
+			comparison = "<=>";
+			break;
+		default:
+			return false;
+		}
+		conditions.push_back(StringUtil::Format("%s %s %s", MysqlQualifiedColumn(left_alias, left_data, left_id),
+																						comparison, MysqlQualifiedColumn(right_alias, right_data, right_id)));
+	}
+
+	// one remote column per binding of the join, in the same order so that projection maps above it still apply
+	auto bindings = join.GetColumnBindings();
+	vector<string> expressions;
+	vector<MysqlColumnInfo> columns;
+	vector<LogicalType> types;
+	for (auto &binding : bindings)
+	{
+		BoundColumnRefExpression colref(LogicalType::ANY, binding);
+		column_t column_id;
+		if (MysqlResolveColumn(left_child, *left_get, colref, column_id) && column_id != COLUMN_IDENTIFIER_ROW_ID)
+		{
+			expressions.push_back(MysqlQualifiedColumn(left_alias, left_data, column_id));
+			columns.push_back(left_data.columns[column_id]);
+			types.push_back(left_data.types[column_id]);
+		}
+		else if (MysqlResolveColumn(right_child, *right_get, colref, column_id) && column_id != COLUMN_IDENTIFIER_ROW_ID)
+		{
+			expressions.push_back(MysqlQualifiedColumn(right_alias, right_data, column_id));
+			columns.push_back(right_data.columns[column_id]);
+			types.push_back(right_data.types[column_id]);
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	vector<string> filters;
+	if (!MysqlTransformTableFilters(*left_get, left_data, filters, left_alias) ||
+			!MysqlTransformTableFilters(*right_get, right_data, filters, right_alias))
+	{
+		return false;
+	}
+
+	left_data.remote_alias = left_alias;
+	left_data.remote_from = StringUtil::Format(
+			"%s.%s AS %s JOIN %s.%s AS %s ON %s",
+			MysqlIdentifier(left_data.schema_name), MysqlIdentifier(left_data.table_name), MysqlIdentifier(left_alias),
+			MysqlIdentifier(right_data.schema_name), MysqlIdentifier(right_data.table_name), MysqlIdentifier(right_alias),
+			StringUtil::Join(conditions, " AND "));
+	left_data.remote_filters = filters;
+	left_data.approx_number_of_rows = join.estimated_cardinality;
+	MysqlSetRemoteColumns(*left_get, left_data, expressions, columns, types);
+	left_get->estimated_cardinality = join.estimated_cardinality;
+	left_get->has_estimated_cardinality = true;
+	for (idx_t i = 0; i < bindings.size(); i++)
+	{
+		replacements[bindings[i]] = ColumnBinding(left_get->table_index, i);
+	}
+	return true;
+}
+
+static void MysqlOptimizeJoins(ClientContext &context, unique_ptr<LogicalOperator> &op,
+															 column_binding_map_t<ColumnBinding> &replacements)
+{
+	for (auto &child : op->children)
+	{
+		MysqlOptimizeJoins(context, child, replacements);
+	}
+	if (op->type == LogicalOperatorType::LOGICAL_COMPARISON_JOIN &&
+			MysqlPushdownJoin(context, op->Cast<LogicalComparisonJoin>(), replacements))
+	{
+		auto scan = MysqlTakeScan(op->children[0]);
+		op = std::move(scan);
+	}
+}
+
+// Points the column references to the bindings of the operators replaced by a scan
+class MysqlBindingReplacer : public LogicalOperatorVisitor
+{
+public:
+	explicit MysqlBindingReplacer(const column_binding_map_t<ColumnBinding> &replacements) : replacements(replacements)
+	{
+	}
+
+	unique_ptr<Expression> VisitReplace(BoundColumnRefExpression &expr, unique_ptr<Expression> *expr_ptr) override
+	{
+		auto entry = replacements.find(expr.binding);
+		if (entry != replacements.end())
+		{
+			expr.binding = entry->second;
+		}
+		return nullptr;
+	}
+
+private:
+	const column_binding_map_t<ColumnBinding> &replacements;
+};
+
+static void MysqlOptimize(ClientContext &context, OptimizerExtensionInfo *info, unique_ptr<LogicalOperator> &plan)
+{
+	// joins first, an aggregate above a join is then right above its scan
+	column_binding_map_t<ColumnBinding> replacements;
+	MysqlOptimizeJoins(context, plan, replacements);
+	if (!replacements.empty())
+	{
+		MysqlBindingReplacer replacer(replacements);
+		replacer.VisitOperator(*plan);
+	}
+	// then aggregates: a LIMIT above an aggregate is not right above the scan
+	MysqlOptimizeAggregates(context, *plan);
+	MysqlOptimizeLimits(*plan);
+}
+
+class MysqlOptimizerExtension : public OptimizerExtension
+{
+public:
+	MysqlOptimizerExtension()
+	{
+		optimize_function = MysqlOptimize;
+	}
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
+#include "native_mysql_connection.hpp"
+#include <spdlog/spdlog.h>
+#include <deque>
+
+using namespace duckdb;
+
+// A column of the scanned table as the binlog describes it: the type and the metadata of its table map event,
+// completed with what the binlog does not tell (signedness, members of a SET)
+struct MysqlBinlogColumn
+{
+	uint8_t type = 0;
+	uint8_t meta0 = 0;
+	uint8_t meta1 = 0;
+	bool is_unsigned = false;
+	vector<string> set_members;
+};
+
+// The rows of a committed transaction, along with the position to resume reading the binlog from after it
+struct MysqlBinlogTransaction
+{
+	unique_ptr<ColumnDataCollection> rows;
+	string file;
+	int64_t position = 0;
+	string gtid;
+};
+
+struct MysqlBinlogState : public GlobalTableFunctionState
+{
+	~MysqlBinlogState()
+	{
+		if (opened)
+		{
+			mysql_binlog_close(conn->get(), &rpl);
+			opened = false;
+		}
+	}
+
+	unique_ptr<NativeMysqlConnection> conn;
+	MYSQL_RPL rpl;
+	bool opened = false;
+	// set once the server reached the end of its binlog
+	bool finished = false;
+	// the GTID set the dump starts after, in the encoding of COM_BINLOG_DUMP_GTID
+	string encoded_gtid_set;
+
+	// position in the binlog of the last event read
+	string file;
+	int64_t position = 0;
+	bool checksum = false;
+
+	// id of the last table map event of the scanned table, and its columns
+	bool has_table = false;
+	uint64_t table_id = 0;
+	vector<MysqlBinlogColumn> columns;
+
+	// rows of the transaction being read: the ones decoded into pending, and the full chunks before them
+	string gtid;
+	unique_ptr<ColumnDataCollection> transaction_rows;
+	DataChunk pending;
+	vector<LogicalType> row_types;
+
+	// committed transactions not returned yet, the first one being scanned
+	std::deque<MysqlBinlogTransaction> ready;
+	bool scanning = false;
+	ColumnDataScanState scan_state;
+	DataChunk scan_chunk;
+};
@@ -2,6 +2,9 @@
 
 #include "duckdb.hpp"
 #include "connection_pool.hpp"
+#include "native_mysql_connection.hpp"
+#include "mysql_result_cache.hpp"
+#include "../model/mysql_scan_stats.hpp"
 
 using namespace duckdb;
 
@@ -10,6 +13,10 @@ struct MysqlGlobalState : public GlobalTableFunctionState
 
 	~MysqlGlobalState()
 	{
+		if (stats)
+		{
+			stats->Finish();
+		}
 		if (pool)
 		{
 			pool->close();
@@ -17,15 +24,39 @@ struct MysqlGlobalState : public GlobalTableFunctionState
 		}
 	}
 
-	MysqlGlobalState(idx_t max_threads) : start_page(0), max_threads(max_threads)
+	MysqlGlobalState(idx_t max_threads) : start_row(0), max_threads(max_threads)
 	{
 	}
 
 	mutex lock;
-	idx_t start_page;
+	// next offset handed out when the scan is paged with LIMIT/OFFSET
+	idx_t start_row;
+	// set once a LIMIT/OFFSET task returned less rows than requested
+	atomic<bool> offset_exhausted {false};
 	idx_t max_threads;
+
+	// bounds of the partition key when the scan is split on a key range
+	int64_t partition_min = 0;
+	int64_t partition_max = 0;
+	// next lower bound handed out when the scan is split on a key range
+	int64_t range_start = 0;
+	// width of each key range, 0 when the scan is paged with LIMIT/OFFSET
+	uint64_t range_size = 0;
+	bool ranges_exhausted = false;
+
 	ConnectionPool *pool = nullptr;
 
+	// connections of the native engine opened ahead of the scan, handed out to the workers as they start
+	vector<unique_ptr<NativeMysqlConnection>> native_connections;
+
+	// set when the result of the scan is read from the local cache instead of MySQL
+	unique_ptr<MysqlResultCacheReader> cache_reader;
+	// set when the result of the scan is written to the local cache as it is read
+	unique_ptr<MysqlResultCacheWriter> cache_writer;
+
+	// counters of the scan, listed by mysql_scan_stats()
+	shared_ptr<MysqlScanStats> stats;
+
 	idx_t MaxThreads() const override
 	{
 		return max_threads;
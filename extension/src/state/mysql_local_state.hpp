@@ -3,41 +3,109 @@
 #include "duckdb.hpp"
 #include "mysql_jdbc.h"
 #include "connection_pool.hpp"
+#include "native_mysql_connection.hpp"
+#include "mysql_native_result.hpp"
 #include <spdlog/spdlog.h>
+#include <future>
 
 using namespace duckdb;
 
-struct MysqlLocalState : public LocalTableFunctionState {
-    ~MysqlLocalState() {
+struct MysqlTypeInfo;
+struct MysqlColumnReader;
+
+// Decodes the value of one column of the current row into the output vector
+typedef void (*mysql_column_decoder_t)(sql::ResultSet* res, const MysqlColumnReader& reader, Vector& out_vec,
+                                       uint32_t col_idx, idx_t output_offset);
+
+// A projected column resolved once per local state into the decoder specialized for its type
+struct MysqlColumnReader {
+    mysql_column_decoder_t decode;
+    LogicalType type;
+    const MysqlTypeInfo* type_info;
+};
+
+// A task handed out by the global state: the key range or the page of the table to read
+struct MysqlTask {
+    std::string filter;
+    std::string limit;
+    // LIMIT of the task, 0 when it reads a whole key range
+    idx_t row_limit = 0;
+};
+
+// A connection owned by a local state along with the query of the task running on it.
+// Each local state has two of them so that the next task is queried while the current one is decoded.
+struct MysqlTaskSlot {
+    ~MysqlTaskSlot() {
+        // the query may still be running in the background
+        if (pending.valid()) {
+            pending.wait();
+        }
+        closeResult();
+        if (pool && conn) {
+            pool->releaseConnection(conn);
+        }
+        conn = nullptr;
+        pool = nullptr;
+    }
+
+    void closeResult() {
         if (result_set) {
             result_set->close();
+            delete result_set;
             result_set = nullptr;
         }
         if (stmt) {
             spdlog::debug("closing statement");
             stmt->close();
+            delete stmt;
             stmt = nullptr;
         }
-        if (pool) {
-            pool->releaseConnection(conn);
-            conn = nullptr;
-            pool = nullptr;
-        }
+        native_result.close();
+    }
+
+    ConnectionPool* pool = nullptr;
+    sql::Connection* conn = nullptr;
+    sql::ResultSet* result_set = nullptr;
+    sql::Statement* stmt = nullptr;
+
+    // native engine, the result is declared after the connection so that its statement is closed first
+    unique_ptr<NativeMysqlConnection> native_conn;
+    MysqlNativeResult native_result;
+
+    // LIMIT of the task running on this slot, 0 when unbounded
+    idx_t task_row_limit = 0;
+    // set while the query of a prefetched task is running
+    std::future<void> pending;
+};
+
+struct MysqlLocalState : public LocalTableFunctionState {
+    MysqlTaskSlot& current() {
+        return slots[current_slot];
+    }
+
+    MysqlTaskSlot& next() {
+        return slots[1 - current_slot];
     }
 
     bool done = false;
     bool exec = false;
     std::string base_sql = "";
-
-    idx_t start_page = 0;
-    idx_t current_page = 0;
-    idx_t end_page = 0;
-    idx_t pagesize = 0;
+    // rows read by the current task
+    idx_t task_row_count = 0;
+    // whether the next slot is running the query of the next task
+    bool prefetching = false;
+    // cleared when the pool had no connection left for the second slot, the tasks are then queried one at a time
+    bool can_prefetch = true;
 
     std::vector<column_t> column_ids;
+    std::vector<MysqlColumnReader> column_readers;
     TableFilterSet* filters;
-    ConnectionPool* pool = nullptr;
-    sql::Connection* conn = nullptr;
-    sql::ResultSet* result_set = nullptr;
-    sql::Statement* stmt = nullptr;
+
+    MysqlTaskSlot slots[2];
+    idx_t current_slot = 0;
+
+    // chunk of the cached result the output references
+    unique_ptr<DataChunk> cache_chunk;
+    // whether this worker ran out of tasks, counted once by the cache writer
+    bool cache_finished = false;
 };
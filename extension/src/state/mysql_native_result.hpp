@@ -0,0 +1,49 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "native_mysql_connection.hpp"
+#include <spdlog/spdlog.h>
+
+using namespace duckdb;
+
+// Result binding of one projected column for the native engine
+struct MysqlNativeColumn {
+    // fixed width values are fetched straight into the output vector memory,
+    // the other ones go through the scratch buffer
+    bool fixed_width = false;
+    // VARCHAR/BLOB values are copied from the protocol buffer straight into the vector string heap,
+    // the scratch buffer only holds the values short enough to be inlined in a string_t
+    bool direct_string = false;
+    // DATE, TIME and TIMESTAMP values are fetched in their binary form into time_value
+    bool temporal = false;
+    MYSQL_TIME time_value;
+    enum_field_types buffer_type = MYSQL_TYPE_STRING;
+    bool is_unsigned = false;
+    idx_t value_size = 0;
+
+    bool is_null = false;
+    bool error = false;
+    unsigned long length = 0;
+    std::vector<char> buffer;
+};
+
+// A running prepared statement of the native engine along with its result bindings
+struct MysqlNativeResult {
+    ~MysqlNativeResult() {
+        close();
+    }
+
+    void close() {
+        if (stmt) {
+            spdlog::debug("closing native statement");
+            mysql_stmt_close(stmt);
+            stmt = nullptr;
+        }
+        columns.clear();
+        binds.clear();
+    }
+
+    MYSQL_STMT* stmt = nullptr;
+    std::vector<MysqlNativeColumn> columns;
+    std::vector<MYSQL_BIND> binds;
+};
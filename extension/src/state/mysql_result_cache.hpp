@@ -0,0 +1,90 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/file_system.hpp"
+#include <spdlog/spdlog.h>
+
+using namespace duckdb;
+
+// Each cached result is a DuckDB database file holding the rows of the scan in table "rows",
+// along with the query they were read with and the version of the MySQL table in table "info"
+#define MYSQL_RESULT_CACHE_ROWS_TABLE "rows"
+#define MYSQL_RESULT_CACHE_INFO_TABLE "info"
+
+// A cached result being served instead of querying MySQL
+struct MysqlResultCacheReader
+{
+	mutex lock;
+	unique_ptr<DuckDB> db;
+	unique_ptr<Connection> con;
+	unique_ptr<QueryResult> result;
+};
+
+// A scan being materialized into the cache. The rows are written to a temporary file that replaces
+// the cached result once every worker of the scan ran out of tasks, a scan stopped early or failing
+// leaves the cache untouched.
+struct MysqlResultCacheWriter
+{
+	~MysqlResultCacheWriter()
+	{
+		auto complete = !failed && workers > 0 && finished_workers == workers;
+		try
+		{
+			if (appender)
+			{
+				if (complete)
+				{
+					appender->Close();
+				}
+				appender.reset();
+			}
+			con.reset();
+			db.reset();
+			auto fs = FileSystem::CreateLocal();
+			if (complete)
+			{
+				fs->MoveFile(tmp_path, path);
+				spdlog::debug("cached scan result in {}", path);
+			}
+			else if (fs->FileExists(tmp_path))
+			{
+				fs->RemoveFile(tmp_path);
+			}
+		}
+		catch (std::exception &e)
+		{
+			spdlog::warn("could not write the scan result cache {}: {}", path, e.what());
+		}
+	}
+
+	void append(DataChunk &chunk)
+	{
+		lock_guard<mutex> guard(lock);
+		if (failed)
+		{
+			return;
+		}
+		try
+		{
+			appender->AppendDataChunk(chunk);
+		}
+		catch (std::exception &e)
+		{
+			// the query goes on, only its result is not cached
+			spdlog::warn("could not write the scan result cache {}: {}", path, e.what());
+			failed = true;
+		}
+	}
+
+	mutex lock;
+	string path;
+	string tmp_path;
+	unique_ptr<DuckDB> db;
+	unique_ptr<Connection> con;
+	unique_ptr<Appender> appender;
+	bool failed = false;
+
+	// local states of the scan, and the ones that ran out of tasks
+	atomic<idx_t> workers {0};
+	atomic<idx_t> finished_workers {0};
+};
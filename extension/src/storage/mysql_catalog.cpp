@@ -0,0 +1,513 @@
+#include "duckdb.hpp"
+#include "duckdb/catalog/catalog_entry/table_function_catalog_entry.hpp"
+#include "duckdb/parser/parsed_data/attach_info.hpp"
+#include "duckdb/parser/parsed_data/create_table_info.hpp"
+#include "duckdb/storage/database_size.hpp"
+#include "duckdb/storage/table_storage_info.hpp"
+
+#include "mysql_catalog.hpp"
+#include "mysql_connection_manager.hpp"
+#include "../duckdb_function/mysql_scan.hpp"
+
+using namespace duckdb;
+
+// Connections of the catalog lookups, the scans size the pool to their needs
+#define MYSQL_CATALOG_POOL_SIZE 5
+
+static ConnectionPool *MysqlCatalogPool(const MysqlConnectionInfo &connection_info)
+{
+	return MySQLConnectionManager::getConnectionPool(1, MYSQL_CATALOG_POOL_SIZE, connection_info.host,
+																									connection_info.username, connection_info.password, connection_info.options);
+}
+
+// Finds the name a MySQL object is stored with, preferring an exact match over a case insensitive one.
+// query selects the candidate names with a %s placeholder for the literal of the lowered name.
+static string MysqlResolveName(ConnectionPool *connection_pool, const string &query, const string &name)
+{
+	auto conn = connection_pool->getConnection();
+	auto stmt = conn->createStatement();
+	auto res = stmt->executeQuery(StringUtil::Format(query, MysqlStringLiteral(StringUtil::Lower(name))));
+	string result;
+	while (res->next())
+	{
+		string candidate = res->getString(1);
+		if (result.empty() || candidate == name)
+		{
+			result = candidate;
+		}
+	}
+	res->close();
+	delete res;
+	stmt->close();
+	delete stmt;
+	connection_pool->releaseConnection(conn);
+	return result;
+}
+
+MysqlConnectionInfo MysqlConnectionInfo::Parse(const string &path)
+{
+	MysqlConnectionInfo result;
+	auto remaining = path;
+	if (StringUtil::StartsWith(remaining, "mysql://"))
+	{
+		remaining = remaining.substr(8);
+	}
+	else if (StringUtil::StartsWith(remaining, "mysql:"))
+	{
+		remaining = remaining.substr(6);
+	}
+
+	// the password may contain '@', the host can not
+	auto at = remaining.rfind('@');
+	if (at != string::npos)
+	{
+		auto user_info = remaining.substr(0, at);
+		remaining = remaining.substr(at + 1);
+		auto colon = user_info.find(':');
+		result.username = user_info.substr(0, colon);
+		if (colon != string::npos)
+		{
+			result.password = user_info.substr(colon + 1);
+		}
+	}
+
+	auto slash = remaining.find('/');
+	if (slash != string::npos)
+	{
+		result.database = remaining.substr(slash + 1);
+		remaining = remaining.substr(0, slash);
+	}
+	result.host = remaining.empty() ? "localhost" : remaining;
+	if (result.username.empty())
+	{
+		result.username = "root";
+	}
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// MysqlTableEntry
+//===--------------------------------------------------------------------===//
+MysqlTableEntry::MysqlTableEntry(Catalog &catalog, SchemaCatalogEntry &schema, CreateTableInfo &info,
+																 MysqlTableMetadata metadata)
+		: TableCatalogEntry(catalog, schema, info), metadata(std::move(metadata))
+{
+}
+
+unique_ptr<BaseStatistics> MysqlTableEntry::GetStatistics(ClientContext &context, column_t column_id)
+{
+	return nullptr;
+}
+
+TableFunction MysqlTableEntry::GetScanFunction(ClientContext &context, unique_ptr<FunctionData> &bind_data)
+{
+	auto &mysql_catalog = catalog.Cast<MysqlCatalog>();
+	auto &mysql_schema = schema.Cast<MysqlSchemaEntry>();
+
+	auto result = make_uniq<MysqlBindData>();
+	result->host = mysql_catalog.connection_info.host;
+	result->username = mysql_catalog.connection_info.username;
+	result->password = mysql_catalog.connection_info.password;
+	result->connection_options = mysql_catalog.connection_info.options;
+	result->schema_name = mysql_schema.mysql_name;
+	result->table_name = name;
+	MysqlBindTable(context, *result, &metadata);
+	bind_data = std::move(result);
+
+	auto &function_entry = Catalog::GetEntry<TableFunctionCatalogEntry>(
+			context, SYSTEM_CATALOG, DEFAULT_SCHEMA, mysql_catalog.filter_pushdown ? "mysql_scan_pushdown" : "mysql_scan");
+	return function_entry.functions.GetFunctionByOffset(0);
+}
+
+TableStorageInfo MysqlTableEntry::GetStorageInfo(ClientContext &context)
+{
+	TableStorageInfo result;
+	auto row_estimate = metadata.row_estimates.find(MysqlEstimateMode::TABLE_ROWS);
+	if (row_estimate != metadata.row_estimates.end())
+	{
+		result.cardinality = row_estimate->second;
+	}
+	return result;
+}
+
+//===--------------------------------------------------------------------===//
+// MysqlSchemaEntry
+//===--------------------------------------------------------------------===//
+MysqlSchemaEntry::MysqlSchemaEntry(Catalog &catalog, string name, string mysql_name)
+		: SchemaCatalogEntry(catalog, std::move(name), true), mysql_name(std::move(mysql_name))
+{
+}
+
+MysqlTableEntry &MysqlSchemaEntry::AddTable(const string &table_name, MysqlTableMetadata metadata)
+{
+	CreateTableInfo info(*this, table_name);
+	for (idx_t col_idx = 0; col_idx < metadata.names.size(); col_idx++)
+	{
+		info.columns.AddColumn(ColumnDefinition(metadata.names[col_idx], metadata.types[col_idx]));
+	}
+	auto entry = make_uniq<MysqlTableEntry>(catalog, *this, info, std::move(metadata));
+	auto &result = *entry;
+	tables[table_name] = std::move(entry);
+	return result;
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::GetEntry(CatalogTransaction transaction, CatalogType type,
+																										 const string &name)
+{
+	if (type != CatalogType::TABLE_ENTRY)
+	{
+		return nullptr;
+	}
+	lock_guard<mutex> guard(entry_lock);
+	auto entry = tables.find(name);
+	if (entry != tables.end())
+	{
+		return entry->second.get();
+	}
+	if (fully_loaded)
+	{
+		return nullptr;
+	}
+
+	// first reference to the table: resolve it and read its columns once
+	auto &connection_info = catalog.Cast<MysqlCatalog>().connection_info;
+	auto connection_pool = MysqlCatalogPool(connection_info);
+	auto table_name = MysqlResolveName(
+			connection_pool,
+			"SELECT table_name FROM information_schema.tables WHERE table_schema = " +
+					StringUtil::Replace(MysqlStringLiteral(mysql_name), "%", "%%") + " AND LOWER(table_name) = %s",
+			name);
+	if (table_name.empty())
+	{
+		return nullptr;
+	}
+
+	MysqlTableMetadata metadata;
+	auto ttl = transaction.context ? MysqlMetadataCacheTTL(*transaction.context) : 0;
+	if (ttl <= 0 || !MysqlMetadataCache::Get().Lookup(connection_info.host, connection_info.username, mysql_name,
+																									 table_name, ttl, metadata))
+	{
+		GetTableTypesInfos(connection_pool, mysql_name, table_name, metadata);
+	}
+	return &AddTable(table_name, std::move(metadata));
+}
+
+void MysqlSchemaEntry::Scan(ClientContext &context, CatalogType type, const std::function<void(CatalogEntry &)> &callback)
+{
+	if (type != CatalogType::TABLE_ENTRY)
+	{
+		return;
+	}
+	{
+		lock_guard<mutex> guard(entry_lock);
+		if (!fully_loaded)
+		{
+			// listing the tables reads all of them with a single query, as mysql_attach does
+			auto &connection_info = catalog.Cast<MysqlCatalog>().connection_info;
+			auto schema_tables = GetSchemaMetadata(MysqlCatalogPool(connection_info), mysql_name);
+			auto cache = MysqlMetadataCacheTTL(context) > 0;
+			for (auto &table : schema_tables)
+			{
+				if (cache)
+				{
+					MysqlMetadataCache::Get().Store(connection_info.host, connection_info.username, mysql_name, table.first,
+																					table.second);
+				}
+				if (tables.find(table.first) == tables.end())
+				{
+					AddTable(table.first, std::move(table.second));
+				}
+			}
+			fully_loaded = true;
+		}
+	}
+	Scan(type, callback);
+}
+
+void MysqlSchemaEntry::Scan(CatalogType type, const std::function<void(CatalogEntry &)> &callback)
+{
+	if (type != CatalogType::TABLE_ENTRY)
+	{
+		return;
+	}
+	lock_guard<mutex> guard(entry_lock);
+	for (auto &table : tables)
+	{
+		callback(*table.second);
+	}
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateTable(CatalogTransaction transaction, BoundCreateTableInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateFunction(CatalogTransaction transaction, CreateFunctionInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateIndex(ClientContext &context, CreateIndexInfo &info,
+																												TableCatalogEntry &table)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateView(CatalogTransaction transaction, CreateViewInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateSequence(CatalogTransaction transaction, CreateSequenceInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateTableFunction(CatalogTransaction transaction,
+																																CreateTableFunctionInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateCopyFunction(CatalogTransaction transaction,
+																															 CreateCopyFunctionInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreatePragmaFunction(CatalogTransaction transaction,
+																																 CreatePragmaFunctionInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateCollation(CatalogTransaction transaction, CreateCollationInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+optional_ptr<CatalogEntry> MysqlSchemaEntry::CreateType(CatalogTransaction transaction, CreateTypeInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+void MysqlSchemaEntry::Alter(ClientContext &context, AlterInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+void MysqlSchemaEntry::DropEntry(ClientContext &context, DropInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+//===--------------------------------------------------------------------===//
+// MysqlCatalog
+//===--------------------------------------------------------------------===//
+MysqlCatalog::MysqlCatalog(AttachedDatabase &db, MysqlConnectionInfo connection_info, bool filter_pushdown)
+		: Catalog(db), connection_info(std::move(connection_info)), filter_pushdown(filter_pushdown)
+{
+}
+
+void MysqlCatalog::Initialize(bool load_builtin)
+{
+	// nothing is read from MySQL before a query references it
+}
+
+MysqlSchemaEntry &MysqlCatalog::AddSchema(const string &schema_name, const string &mysql_name)
+{
+	auto entry = make_uniq<MysqlSchemaEntry>(*this, schema_name, mysql_name);
+	auto &result = *entry;
+	schemas[schema_name] = std::move(entry);
+	return result;
+}
+
+optional_ptr<SchemaCatalogEntry> MysqlCatalog::GetSchema(CatalogTransaction transaction, const string &schema_name,
+																												 OnEntryNotFound if_not_found, QueryErrorContext error_context)
+{
+	lock_guard<mutex> guard(entry_lock);
+	auto entry = schemas.find(schema_name);
+	if (entry != schemas.end())
+	{
+		return entry->second.get();
+	}
+
+	auto mysql_name = schema_name == DEFAULT_SCHEMA ? connection_info.database : schema_name;
+	if (!mysql_name.empty())
+	{
+		mysql_name = MysqlResolveName(MysqlCatalogPool(connection_info),
+																	"SELECT schema_name FROM information_schema.schemata WHERE LOWER(schema_name) = %s",
+																	mysql_name);
+	}
+	if (mysql_name.empty())
+	{
+		if (if_not_found == OnEntryNotFound::RETURN_NULL)
+		{
+			return nullptr;
+		}
+		throw BinderException("Schema with name \"%s\" not found in MySQL database \"%s\"", schema_name, GetName());
+	}
+	return &AddSchema(schema_name, mysql_name);
+}
+
+void MysqlCatalog::ScanSchemas(ClientContext &context, std::function<void(SchemaCatalogEntry &)> callback)
+{
+	vector<string> schema_names;
+	{
+		auto conn_pool = MysqlCatalogPool(connection_info);
+		auto conn = conn_pool->getConnection();
+		auto stmt = conn->createStatement();
+		auto res = stmt->executeQuery("SELECT schema_name FROM information_schema.schemata");
+		while (res->next())
+		{
+			schema_names.push_back(res->getString(1));
+		}
+		res->close();
+		delete res;
+		stmt->close();
+		delete stmt;
+		conn_pool->releaseConnection(conn);
+	}
+
+	lock_guard<mutex> guard(entry_lock);
+	if (!connection_info.database.empty() && schemas.find(DEFAULT_SCHEMA) == schemas.end())
+	{
+		AddSchema(DEFAULT_SCHEMA, connection_info.database);
+	}
+	for (auto &schema_name : schema_names)
+	{
+		if (schemas.find(schema_name) == schemas.end())
+		{
+			AddSchema(schema_name, schema_name);
+		}
+	}
+	for (auto &schema : schemas)
+	{
+		callback(*schema.second);
+	}
+}
+
+optional_ptr<CatalogEntry> MysqlCatalog::CreateSchema(CatalogTransaction transaction, CreateSchemaInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+void MysqlCatalog::DropSchema(ClientContext &context, DropInfo &info)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+unique_ptr<PhysicalOperator> MysqlCatalog::PlanInsert(ClientContext &context, LogicalInsert &op,
+																											unique_ptr<PhysicalOperator> plan)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+unique_ptr<PhysicalOperator> MysqlCatalog::PlanCreateTableAs(ClientContext &context, LogicalCreateTable &op,
+																														 unique_ptr<PhysicalOperator> plan)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+unique_ptr<PhysicalOperator> MysqlCatalog::PlanDelete(ClientContext &context, LogicalDelete &op,
+																											unique_ptr<PhysicalOperator> plan)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+unique_ptr<PhysicalOperator> MysqlCatalog::PlanUpdate(ClientContext &context, LogicalUpdate &op,
+																											unique_ptr<PhysicalOperator> plan)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+unique_ptr<LogicalOperator> MysqlCatalog::BindCreateIndex(Binder &binder, CreateStatement &stmt, TableCatalogEntry &table,
+																													unique_ptr<LogicalOperator> plan)
+{
+	throw NotImplementedException("Attached MySQL databases are read-only");
+}
+
+DatabaseSize MysqlCatalog::GetDatabaseSize(ClientContext &context)
+{
+	DatabaseSize result {};
+	return result;
+}
+
+bool MysqlCatalog::InMemory()
+{
+	return false;
+}
+
+string MysqlCatalog::GetDBPath()
+{
+	// the password is left out on purpose, the path shows up in duckdb_databases()
+	return "mysql://" + connection_info.username + "@" + connection_info.host + "/" + connection_info.database;
+}
+
+//===--------------------------------------------------------------------===//
+// MysqlTransactionManager
+//===--------------------------------------------------------------------===//
+MysqlTransactionManager::MysqlTransactionManager(AttachedDatabase &db) : TransactionManager(db)
+{
+}
+
+Transaction &MysqlTransactionManager::StartTransaction(ClientContext &context)
+{
+	auto transaction = make_uniq<Transaction>(*this, context);
+	auto &result = *transaction;
+	lock_guard<mutex> guard(transaction_lock);
+	transactions[result] = std::move(transaction);
+	return result;
+}
+
+string MysqlTransactionManager::CommitTransaction(ClientContext &context, Transaction &transaction)
+{
+	lock_guard<mutex> guard(transaction_lock);
+	transactions.erase(transaction);
+	return string();
+}
+
+void MysqlTransactionManager::RollbackTransaction(Transaction &transaction)
+{
+	lock_guard<mutex> guard(transaction_lock);
+	transactions.erase(transaction);
+}
+
+void MysqlTransactionManager::Checkpoint(ClientContext &context, bool force)
+{
+}
+
+//===--------------------------------------------------------------------===//
+// MysqlStorageExtension
+//===--------------------------------------------------------------------===//
+static unique_ptr<Catalog> MysqlAttach(StorageExtensionInfo *storage_info, AttachedDatabase &db, const string &name,
+																			 AttachInfo &info, AccessMode access_mode)
+{
+	auto filter_pushdown = true;
+	auto connection_info = MysqlConnectionInfo::Parse(info.path);
+	for (auto &entry : info.options)
+	{
+		if (MysqlSetConnectionOption(connection_info.options, entry.first, entry.second))
+		{
+			continue;
+		}
+		if (StringUtil::Lower(entry.first) == "filter_pushdown")
+		{
+			filter_pushdown = BooleanValue::Get(entry.second.DefaultCastAs(LogicalType::BOOLEAN));
+		}
+	}
+	MysqlCheckConnectionOptions(connection_info.options);
+	return make_uniq<MysqlCatalog>(db, std::move(connection_info), filter_pushdown);
+}
+
+static unique_ptr<TransactionManager> MysqlCreateTransactionManager(StorageExtensionInfo *storage_info,
+																																		AttachedDatabase &db, Catalog &catalog)
+{
+	return make_uniq<MysqlTransactionManager>(db);
+}
+
+MysqlStorageExtension::MysqlStorageExtension()
+{
+	attach = MysqlAttach;
+	create_transaction_manager = MysqlCreateTransactionManager;
+}
@@ -0,0 +1,171 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include <cmath>
+
+using namespace duckdb;
+
+static string MysqlIdentifier(const string &name)
+{
+	return "`" + StringUtil::Replace(name, "`", "``") + "`";
+}
+
+static string MysqlHexString(const string &data)
+{
+	static const char *digits = "0123456789ABCDEF";
+	string result;
+	result.reserve(data.size() * 2);
+	for (auto c : data)
+	{
+		auto byte = (uint8_t)c;
+		result += digits[byte >> 4];
+		result += digits[byte & 0x0F];
+	}
+	return result;
+}
+
+// Renders a string as a MySQL literal. Quotes are doubled, which MySQL reads the same way whatever the sql_mode;
+// strings with backslashes or control characters are sent in hexadecimal instead, as NO_BACKSLASH_ESCAPES
+// changes how backslashes are read. The introducer keeps the literal a character string (not a binary one),
+// so it compares with the collation of the column and range access on its indexes still applies.
+string MysqlStringLiteral(const string &value)
+{
+	for (auto c : value)
+	{
+		if (c == '\\' || (uint8_t)c < 0x20)
+		{
+			return "_utf8mb4 X'" + MysqlHexString(value) + "'";
+		}
+	}
+	return "'" + StringUtil::Replace(value, "'", "''") + "'";
+}
+
+// Renders a DuckDB value as a literal of the matching MySQL type, so that comparisons with numeric and temporal
+// columns are not made on strings. Returns false for the values MySQL has no literal for (NaN, infinities).
+static bool TryMysqlLiteral(const Value &value, string &result)
+{
+	if (value.IsNull())
+	{
+		result = "NULL";
+		return true;
+	}
+	switch (value.type().id())
+	{
+	case LogicalTypeId::BOOLEAN:
+		result = BooleanValue::Get(value) ? "TRUE" : "FALSE";
+		return true;
+	case LogicalTypeId::TINYINT:
+	case LogicalTypeId::SMALLINT:
+	case LogicalTypeId::INTEGER:
+	case LogicalTypeId::BIGINT:
+	case LogicalTypeId::UTINYINT:
+	case LogicalTypeId::USMALLINT:
+	case LogicalTypeId::UINTEGER:
+	case LogicalTypeId::UBIGINT:
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::DECIMAL:
+		result = value.ToString();
+		return true;
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	{
+		auto double_value = value.GetValue<double>();
+		if (!Value::DoubleIsFinite(double_value))
+		{
+			return false;
+		}
+		// the exponent form keeps the value a floating point literal instead of an exact DECIMAL one
+		result = StringUtil::Format("%.17e", double_value);
+		return true;
+	}
+	case LogicalTypeId::DATE:
+	{
+		if (!Value::IsFinite(value.GetValue<date_t>()))
+		{
+			return false;
+		}
+		result = "DATE '" + value.ToString() + "'";
+		return true;
+	}
+	case LogicalTypeId::TIME:
+		result = "TIME '" + value.ToString() + "'";
+		return true;
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_SEC:
+	case LogicalTypeId::TIMESTAMP_MS:
+	case LogicalTypeId::TIMESTAMP_NS:
+	{
+		// MySQL accepts up to microseconds
+		auto timestamp = value.DefaultCastAs(LogicalType::TIMESTAMP);
+		if (!Value::IsFinite(timestamp.GetValue<timestamp_t>()))
+		{
+			return false;
+		}
+		result = "TIMESTAMP '" + timestamp.ToString() + "'";
+		return true;
+	}
+	case LogicalTypeId::VARCHAR:
+	case LogicalTypeId::ENUM:
+		result = MysqlStringLiteral(value.ToString());
+		return true;
+	case LogicalTypeId::BLOB:
+		result = "X'" + MysqlHexString(StringValue::Get(value)) + "'";
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Whether a value is one of the values MySQL can not store (NaN, infinite doubles, dates and timestamps), and then
+// whether it sorts above every finite value, as NaN and the positive infinities do in DuckDB, or below them
+static bool MysqlIsNonFinite(const Value &value, bool &above)
+{
+	if (value.IsNull())
+	{
+		return false;
+	}
+	switch (value.type().id())
+	{
+	case LogicalTypeId::FLOAT:
+	case LogicalTypeId::DOUBLE:
+	{
+		auto double_value = value.GetValue<double>();
+		above = std::isnan(double_value) || double_value > 0;
+		return !Value::DoubleIsFinite(double_value);
+	}
+	case LogicalTypeId::DATE:
+	{
+		auto date = value.GetValue<date_t>();
+		above = date == date_t::infinity();
+		return !Value::IsFinite(date);
+	}
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_SEC:
+	case LogicalTypeId::TIMESTAMP_MS:
+	case LogicalTypeId::TIMESTAMP_NS:
+	{
+		auto timestamp = value.DefaultCastAs(LogicalType::TIMESTAMP).GetValue<timestamp_t>();
+		above = timestamp == timestamp_t::infinity();
+		return !Value::IsFinite(timestamp);
+	}
+	default:
+		return false;
+	}
+}
+
+// Same as TryMysqlLiteral, falling back to the string form of the value for the types without a MySQL literal.
+// The non finite values have no MySQL counterpart at all, and MySQL would read their string form as 0.
+static string MysqlLiteral(const Value &value)
+{
+	string result;
+	if (TryMysqlLiteral(value, result))
+	{
+		return result;
+	}
+	bool above;
+	if (MysqlIsNonFinite(value, above))
+	{
+		throw InvalidInputException("MySQL has no literal for the value %s", value.ToString());
+	}
+	return MysqlStringLiteral(value.ToString());
+}
@@ -1,3 +1,4 @@
+#pragma once
 #include "duckdb.hpp"
 
 #include "../model/mysql_bind_data.hpp"
@@ -5,6 +6,14 @@
 
 #include "duckdb/planner/filter/conjunction_filter.hpp"
 #include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/expression/bound_between_expression.hpp"
+#include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_constant_expression.hpp"
+#include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/operator/logical_get.hpp"
+
+#include "duckdb_to_mysql_literal.cpp"
 
 using namespace duckdb;
 
@@ -41,6 +50,61 @@ static string TransformComparision(ExpressionType type)
 	}
 }
 
+// A range on a single column, i.e. what DuckDB turns BETWEEN into, is sent as BETWEEN
+static bool TransformBetween(string &column_name, ConjunctionAndFilter &filter, string &result)
+{
+	if (filter.child_filters.size() != 2 ||
+			filter.child_filters[0]->filter_type != TableFilterType::CONSTANT_COMPARISON ||
+			filter.child_filters[1]->filter_type != TableFilterType::CONSTANT_COMPARISON)
+	{
+		return false;
+	}
+	auto lower = (ConstantFilter *)filter.child_filters[0].get();
+	auto upper = (ConstantFilter *)filter.child_filters[1].get();
+	if (lower->comparison_type == ExpressionType::COMPARE_LESSTHANOREQUALTO)
+	{
+		std::swap(lower, upper);
+	}
+	bool above;
+	if (lower->comparison_type != ExpressionType::COMPARE_GREATERTHANOREQUALTO ||
+			upper->comparison_type != ExpressionType::COMPARE_LESSTHANOREQUALTO ||
+			MysqlIsNonFinite(lower->constant, above) || MysqlIsNonFinite(upper->constant, above))
+	{
+		// the non finite bounds are translated one comparison at a time
+		return false;
+	}
+	result = StringUtil::Format("%s BETWEEN %s AND %s", column_name, MysqlLiteral(lower->constant),
+															MysqlLiteral(upper->constant));
+	return true;
+}
+
+// A comparison with a value MySQL can not store: every non NULL value of the column is below it (NaN, infinity)
+// or above it (-infinity), so the comparison holds either for all of them or for none
+static string TransformNonFiniteComparison(string &column_name, ExpressionType comparison_type, bool above)
+{
+	bool holds;
+	switch (comparison_type)
+	{
+	case ExpressionType::COMPARE_EQUAL:
+		holds = false;
+		break;
+	case ExpressionType::COMPARE_NOTEQUAL:
+		holds = true;
+		break;
+	case ExpressionType::COMPARE_LESSTHAN:
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		holds = above;
+		break;
+	case ExpressionType::COMPARE_GREATERTHAN:
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+		holds = !above;
+		break;
+	default:
+		throw NotImplementedException("Unsupported expression type");
+	}
+	return holds ? column_name + " IS NOT NULL" : "FALSE";
+}
+
 static string TransformFilter(string &column_name, TableFilter &filter)
 {
 	switch (filter.filter_type)
@@ -52,18 +116,28 @@ static string TransformFilter(string &column_name, TableFilter &filter)
 	case TableFilterType::CONJUNCTION_AND:
 	{
 		auto &conjunction_filter = (ConjunctionAndFilter &)filter;
+		string between;
+		if (TransformBetween(column_name, conjunction_filter, between))
+		{
+			return between;
+		}
 		return CreateExpression(column_name, conjunction_filter.child_filters, "AND");
 	}
 	case TableFilterType::CONJUNCTION_OR:
 	{
-		auto &conjunction_filter = (ConjunctionAndFilter &)filter;
+		auto &conjunction_filter = (ConjunctionOrFilter &)filter;
 		return CreateExpression(column_name, conjunction_filter.child_filters, "OR");
 	}
 	case TableFilterType::CONSTANT_COMPARISON:
 	{
 		auto &constant_filter = (ConstantFilter &)filter;
-		// TODO properly escape ' in constant value
-		auto constant_string = "'" + constant_filter.constant.ToString() + "'";
+		bool above;
+		if (MysqlIsNonFinite(constant_filter.constant, above))
+		{
+			return TransformNonFiniteComparison(column_name, constant_filter.comparison_type, above);
+		}
+		// typed literals let MySQL compare numbers and dates natively and use range access on indexes
+		auto constant_string = MysqlLiteral(constant_filter.constant);
 		auto operator_string = TransformComparision(constant_filter.comparison_type);
 		return StringUtil::Format("%s %s %s", column_name, operator_string, constant_string);
 	}
@@ -72,7 +146,179 @@ static string TransformFilter(string &column_name, TableFilter &filter)
 	}
 }
 
-static string DuckDBToMySqlRequest(const MysqlBindData *bind_data_p, MysqlLocalState &lstate)
+// SQL reading a column of the scan: its name, or the expression the optimizer extension replaced it with
+static string MysqlColumnExpression(const MysqlBindData &bind_data, column_t column_id)
+{
+	if (!bind_data.remote_expressions.empty())
+	{
+		return bind_data.remote_expressions[column_id];
+	}
+	return MysqlIdentifier(bind_data.names[column_id]);
+}
+
+// Name of the scanned column an expression reads as is, the casted and rowid columns have no remote counterpart
+static bool TransformColumnRef(const LogicalGet &get, const MysqlBindData &bind_data, Expression &expr, string &column_name)
+{
+	if (expr.type != ExpressionType::BOUND_COLUMN_REF)
+	{
+		return false;
+	}
+	auto &colref = expr.Cast<BoundColumnRefExpression>();
+	if (colref.binding.table_index != get.table_index || colref.depth > 0)
+	{
+		return false;
+	}
+	auto column_id = get.column_ids[colref.binding.column_index];
+	if (column_id == COLUMN_IDENTIFIER_ROW_ID || bind_data.needs_cast[column_id])
+	{
+		return false;
+	}
+	column_name = MysqlColumnExpression(bind_data, column_id);
+	return true;
+}
+
+static bool TransformConstant(Expression &expr, string &literal)
+{
+	if (expr.type != ExpressionType::VALUE_CONSTANT)
+	{
+		return false;
+	}
+	return TryMysqlLiteral(expr.Cast<BoundConstantExpression>().value, literal);
+}
+
+// Escapes the wildcards of a text matched literally by a LIKE pattern using '!' as escape character
+static string MysqlLikeText(const string &text)
+{
+	auto result = StringUtil::Replace(text, "!", "!!");
+	result = StringUtil::Replace(result, "%", "!%");
+	return StringUtil::Replace(result, "_", "!_");
+}
+
+// Translates the filters DuckDB can not express as table filters: IN lists, BETWEEN and the LIKE family.
+// DuckDB still evaluates them on the rows MySQL returns, so the remote condition may select more rows
+// (e.g. with case insensitive collations) but never less.
+static bool TransformExpression(const LogicalGet &get, const MysqlBindData &bind_data, Expression &expr, string &result)
+{
+	switch (expr.GetExpressionClass())
+	{
+	case ExpressionClass::BOUND_OPERATOR:
+	{
+		if (expr.type != ExpressionType::COMPARE_IN && expr.type != ExpressionType::COMPARE_NOT_IN)
+		{
+			return false;
+		}
+		auto &op = expr.Cast<BoundOperatorExpression>();
+		string column_name;
+		if (!TransformColumnRef(get, bind_data, *op.children[0], column_name))
+		{
+			return false;
+		}
+		vector<string> values;
+		for (idx_t child_idx = 1; child_idx < op.children.size(); child_idx++)
+		{
+			string literal;
+			if (!TransformConstant(*op.children[child_idx], literal))
+			{
+				return false;
+			}
+			values.push_back(literal);
+		}
+		result = StringUtil::Format("%s %s (%s)", column_name, expr.type == ExpressionType::COMPARE_IN ? "IN" : "NOT IN",
+																StringUtil::Join(values, ", "));
+		return true;
+	}
+	case ExpressionClass::BOUND_BETWEEN:
+	{
+		auto &between = expr.Cast<BoundBetweenExpression>();
+		string column_name;
+		string lower;
+		string upper;
+		if (!TransformColumnRef(get, bind_data, *between.input, column_name) ||
+				!TransformConstant(*between.lower, lower) || !TransformConstant(*between.upper, upper))
+		{
+			return false;
+		}
+		if (between.lower_inclusive && between.upper_inclusive)
+		{
+			result = StringUtil::Format("%s BETWEEN %s AND %s", column_name, lower, upper);
+		}
+		else
+		{
+			result = StringUtil::Format("%s %s %s AND %s %s %s", column_name, between.lower_inclusive ? ">=" : ">", lower,
+																	column_name, between.upper_inclusive ? "<=" : "<", upper);
+		}
+		return true;
+	}
+	case ExpressionClass::BOUND_FUNCTION:
+	{
+		auto &function = expr.Cast<BoundFunctionExpression>();
+		string column_name;
+		if (function.children.size() != 2 || function.children[1]->type != ExpressionType::VALUE_CONSTANT ||
+				!TransformColumnRef(get, bind_data, *function.children[0], column_name))
+		{
+			return false;
+		}
+		auto &constant = function.children[1]->Cast<BoundConstantExpression>().value;
+		if (constant.IsNull() || constant.type().id() != LogicalTypeId::VARCHAR)
+		{
+			return false;
+		}
+		auto &text = StringValue::Get(constant);
+		auto &name = function.function.name;
+		string pattern;
+		if (name == "prefix")
+		{
+			// a constant prefix lets MySQL use a range on the index of the column
+			pattern = MysqlLikeText(text) + "%";
+		}
+		else if (name == "suffix")
+		{
+			pattern = "%" + MysqlLikeText(text);
+		}
+		else if (name == "contains")
+		{
+			pattern = "%" + MysqlLikeText(text) + "%";
+		}
+		else if (name == "~~")
+		{
+			// DuckDB patterns have no escape character, only the one of MySQL needs escaping
+			pattern = StringUtil::Replace(text, "!", "!!");
+		}
+		else
+		{
+			return false;
+		}
+		result = StringUtil::Format("%s LIKE %s ESCAPE '!'", column_name, MysqlStringLiteral(pattern));
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+// The conditions the rows of a scan are selected with: its table filters and the filters pushed down
+// through pushdown_complex_filter
+static vector<string> MysqlFilterEntries(const MysqlBindData &bind_data, MysqlLocalState &lstate)
+{
+	vector<string> filter_entries;
+	if (lstate.filters && !lstate.filters->filters.empty())
+	{
+		for (auto &entry : lstate.filters->filters)
+		{
+			auto column_name = MysqlColumnExpression(bind_data, lstate.column_ids[entry.first]);
+			auto &filter = *entry.second;
+			filter_entries.push_back(TransformFilter(column_name, filter));
+		}
+	}
+	// IN, BETWEEN and LIKE filters pushed down through pushdown_complex_filter
+	for (auto &remote_filter : bind_data.remote_filters)
+	{
+		filter_entries.push_back(remote_filter);
+	}
+	return filter_entries;
+}
+
+static string DuckDBToMySqlRequest(const MysqlBindData *bind_data_p, MysqlLocalState &lstate, const string &task_filter = "")
 {
 	D_ASSERT(bind_data_p);
 	auto bind_data = (const MysqlBindData *)bind_data_p;
@@ -84,29 +330,50 @@ static string DuckDBToMySqlRequest(const MysqlBindData *bind_data_p, MysqlLocalS
 			lstate.column_ids.size(),
 			", ",
 			[&](const idx_t column_id)
-			{ return StringUtil::Format("`%s`%s",
-																	bind_data->names[column_id],
+			{
+				// the rowid has no MySQL counterpart, e.g. SELECT count(*) only needs the rows
+				if (column_id == COLUMN_IDENTIFIER_ROW_ID)
+				{
+					return string("NULL");
+				}
+				// partial aggregates pushed down by the optimizer extension
+				if (!bind_data->remote_expressions.empty())
+				{
+					return bind_data->remote_expressions[column_id];
+				}
+				return StringUtil::Format("%s%s",
+																	MysqlIdentifier(bind_data->names[column_id]),
 																	bind_data->needs_cast[column_id] ? "::VARCHAR" : ""); });
 
 	string filter_string;
-	if (lstate.filters && !lstate.filters->filters.empty())
+	auto filter_entries = MysqlFilterEntries(*bind_data, lstate);
+	// the task filter restricts the query to the key range assigned to this task
+	if (!task_filter.empty())
+	{
+		filter_entries.push_back(task_filter);
+	}
+	if (!filter_entries.empty())
 	{
-		vector<string> filter_entries;
-		for (auto &entry : lstate.filters->filters)
-		{
-			// TODO properly escape " in column names
-			auto column_name = "`" + bind_data->names[lstate.column_ids[entry.first]] + "`";
-			auto &filter = *entry.second;
-			filter_entries.push_back(TransformFilter(column_name, filter));
-		}
 		filter_string = " WHERE " + StringUtil::Join(filter_entries, " AND ");
 	}
 
+	if (!bind_data->remote_group_by.empty())
+	{
+		filter_string += " GROUP BY " + bind_data->remote_group_by;
+	}
+
+	// a join pushed down by the optimizer extension reads from several tables
+	auto from = bind_data->remote_from;
+	if (from.empty())
+	{
+		from = MysqlIdentifier(bind_data->schema_name) + "." + MysqlIdentifier(bind_data->table_name);
+	}
+
 	return StringUtil::Format(
 			R"(
-			SELECT %s FROM `%s`.`%s` %s
+			SELECT %s FROM %s %s
 			)",
 
-			col_names, bind_data->schema_name, bind_data->table_name, filter_string);
+			col_names, from, filter_string);
 
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "../model/mysql_bind_data.hpp"
+#include "../state/mysql_native_result.hpp"
+#include "../state/mysql_local_state.hpp"
+#include "mysql_to_duckdb_result.cpp"
+#include <spdlog/spdlog.h>
+#include <cstring>
+
+using namespace duckdb;
+
+// initial size of the scratch buffer of variable width columns, grown on demand
+#define MYSQL_NATIVE_INITIAL_BUFFER_SIZE 256
+
+static void MysqlNativeBindColumn(MysqlNativeColumn &column, MYSQL_BIND &bind, const LogicalType &type)
+{
+	column.fixed_width = true;
+	column.direct_string = false;
+	column.temporal = false;
+	column.is_unsigned = false;
+	switch (type.id())
+	{
+	case LogicalTypeId::TINYINT:
+		column.buffer_type = MYSQL_TYPE_TINY;
+		column.value_size = sizeof(int8_t);
+		break;
+	case LogicalTypeId::SMALLINT:
+		column.buffer_type = MYSQL_TYPE_SHORT;
+		column.value_size = sizeof(int16_t);
+		break;
+	case LogicalTypeId::INTEGER:
+		column.buffer_type = MYSQL_TYPE_LONG;
+		column.value_size = sizeof(int32_t);
+		break;
+	case LogicalTypeId::UINTEGER:
+		column.buffer_type = MYSQL_TYPE_LONG;
+		column.is_unsigned = true;
+		column.value_size = sizeof(uint32_t);
+		break;
+	case LogicalTypeId::BIGINT:
+		column.buffer_type = MYSQL_TYPE_LONGLONG;
+		column.value_size = sizeof(int64_t);
+		break;
+	case LogicalTypeId::FLOAT:
+		column.buffer_type = MYSQL_TYPE_FLOAT;
+		column.value_size = sizeof(float);
+		break;
+	case LogicalTypeId::DOUBLE:
+		column.buffer_type = MYSQL_TYPE_DOUBLE;
+		column.value_size = sizeof(double);
+		break;
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR:
+		column.fixed_width = false;
+		column.direct_string = true;
+		column.buffer_type = type.id() == LogicalTypeId::BLOB ? MYSQL_TYPE_BLOB : MYSQL_TYPE_STRING;
+		column.value_size = 0;
+		column.buffer.resize(string_t::INLINE_LENGTH);
+		break;
+	case LogicalTypeId::DATE:
+		column.fixed_width = false;
+		column.temporal = true;
+		column.buffer_type = MYSQL_TYPE_DATE;
+		column.value_size = 0;
+		break;
+	case LogicalTypeId::TIME:
+		column.fixed_width = false;
+		column.temporal = true;
+		column.buffer_type = MYSQL_TYPE_TIME;
+		column.value_size = 0;
+		break;
+	case LogicalTypeId::TIMESTAMP:
+		column.fixed_width = false;
+		column.temporal = true;
+		column.buffer_type = MYSQL_TYPE_DATETIME;
+		column.value_size = 0;
+		break;
+	default:
+		// everything else is fetched in its text form and converted afterwards
+		column.fixed_width = false;
+		column.buffer_type = MYSQL_TYPE_STRING;
+		column.value_size = 0;
+		column.buffer.resize(MYSQL_NATIVE_INITIAL_BUFFER_SIZE);
+		break;
+	}
+
+	memset(&bind, 0, sizeof(MYSQL_BIND));
+	bind.buffer_type = column.buffer_type;
+	bind.is_unsigned = column.is_unsigned;
+	bind.is_null = &column.is_null;
+	bind.error = &column.error;
+	bind.length = &column.length;
+	if (column.temporal)
+	{
+		bind.buffer = &column.time_value;
+		bind.buffer_length = sizeof(MYSQL_TIME);
+	}
+	else if (!column.fixed_width)
+	{
+		bind.buffer = column.buffer.data();
+		bind.buffer_length = column.buffer.size();
+	}
+}
+
+// Prepares and executes the query of a task with the binary protocol and binds its result columns
+static void MysqlNativeExecute(MysqlNativeResult &result, MYSQL *mysql, const string &sql,
+															 const vector<LogicalType> &types, bool streaming)
+{
+	result.close();
+	result.stmt = mysql_stmt_init(mysql);
+	if (!result.stmt)
+	{
+		throw IOException("Unable to create a MySQL statement: %s", mysql_error(mysql));
+	}
+	if (mysql_stmt_prepare(result.stmt, sql.c_str(), sql.size()) != 0)
+	{
+		throw IOException("Unable to prepare MySQL query: %s", mysql_stmt_error(result.stmt));
+	}
+	if (mysql_stmt_execute(result.stmt) != 0)
+	{
+		throw IOException("Unable to execute MySQL query: %s", mysql_stmt_error(result.stmt));
+	}
+	// without store_result the rows are read from the socket as they are fetched
+	if (!streaming && mysql_stmt_store_result(result.stmt) != 0)
+	{
+		throw IOException("Unable to read MySQL result: %s", mysql_stmt_error(result.stmt));
+	}
+
+	auto field_count = mysql_stmt_field_count(result.stmt);
+	if (field_count != types.size())
+	{
+		throw InternalException("MySQL returned %d columns, expected %d", (int64_t)field_count, (int64_t)types.size());
+	}
+	result.columns.resize(field_count);
+	result.binds.resize(field_count);
+	for (idx_t col_idx = 0; col_idx < field_count; col_idx++)
+	{
+		MysqlNativeBindColumn(result.columns[col_idx], result.binds[col_idx], types[col_idx]);
+	}
+}
+
+static void MysqlNativeStoreText(Vector &out_vec, const LogicalType &type, const char *data, idx_t length, idx_t output_offset)
+{
+	switch (type.id())
+	{
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR:
+		FlatVector::GetData<string_t>(out_vec)[output_offset] = StringVector::AddStringOrBlob(out_vec, data, length);
+		break;
+	case LogicalTypeId::BOOLEAN:
+		FlatVector::GetData<bool>(out_vec)[output_offset] = !(length == 1 && data[0] == '0');
+		break;
+	case LogicalTypeId::ENUM:
+		StoreEnumValue(out_vec, type, string_t(data, length), output_offset);
+		break;
+	case LogicalTypeId::HUGEINT:
+	case LogicalTypeId::DECIMAL:
+		// MYSQL_TYPE_NEWDECIMAL values are only available in their text form, parsed from the scratch buffer
+		StoreDecimalValue(out_vec, type, data, length, output_offset);
+		break;
+	default:
+	{
+		auto value = Value(string(data, length)).DefaultCastAs(type);
+		out_vec.SetValue(output_offset, value);
+		break;
+	}
+	}
+}
+
+// Converts the broken down MYSQL_TIME the client library decoded from the binary protocol, no text involved.
+// The zero dates and the times outside of a day have no DuckDB counterpart and are read as NULL.
+static void MysqlNativeStoreTemporal(Vector &out_vec, const LogicalType &type, const MYSQL_TIME &value, idx_t output_offset)
+{
+	if (type.id() == LogicalTypeId::TIME)
+	{
+		if (value.neg || value.day != 0 || value.hour >= Interval::HOURS_PER_DAY)
+		{
+			FlatVector::SetNull(out_vec, output_offset, true);
+			return;
+		}
+		FlatVector::GetData<dtime_t>(out_vec)[output_offset] =
+				Time::FromTime(value.hour, value.minute, value.second, value.second_part);
+		return;
+	}
+	if (value.month == 0 || value.day == 0 || !Date::IsValid(value.year, value.month, value.day))
+	{
+		FlatVector::SetNull(out_vec, output_offset, true);
+		return;
+	}
+	auto date = Date::FromDate(value.year, value.month, value.day);
+	if (type.id() == LogicalTypeId::DATE)
+	{
+		FlatVector::GetData<date_t>(out_vec)[output_offset] = date;
+		return;
+	}
+	FlatVector::GetData<timestamp_t>(out_vec)[output_offset] =
+			Timestamp::FromDatetime(date, Time::FromTime(value.hour, value.minute, value.second, value.second_part));
+}
+
+// Short strings were fetched whole into the inline sized scratch buffer and are inlined in the string_t.
+// Longer ones were truncated: their exact size is now known, so they are read from the row buffer
+// of the protocol layer once, straight into space allocated in the string heap of the output vector.
+static void MysqlNativeStoreString(MysqlNativeResult &result, MysqlNativeColumn &column, MYSQL_BIND &bind,
+																	 idx_t col_idx, Vector &out_vec, idx_t output_offset)
+{
+	if (column.length <= string_t::INLINE_LENGTH)
+	{
+		FlatVector::GetData<string_t>(out_vec)[output_offset] = string_t(column.buffer.data(), column.length);
+		return;
+	}
+	auto target = StringVector::EmptyString(out_vec, column.length);
+	bind.buffer = target.GetDataWriteable();
+	bind.buffer_length = column.length;
+	auto status = mysql_stmt_fetch_column(result.stmt, &bind, col_idx, 0);
+	// the next row is bound to the inline buffer again
+	bind.buffer = column.buffer.data();
+	bind.buffer_length = column.buffer.size();
+	if (status != 0)
+	{
+		throw IOException("Unable to fetch MySQL column: %s", mysql_stmt_error(result.stmt));
+	}
+	target.Finalize();
+	FlatVector::GetData<string_t>(out_vec)[output_offset] = target;
+}
+
+// Fetches up to STANDARD_VECTOR_SIZE rows of the running statement into the output chunk.
+// Fixed width columns are bound to the slot of the current row in the output vector,
+// so libmysqlclient decodes them in place; the null indicators become the validity mask.
+static idx_t MysqlNativeFetchChunk(MysqlNativeResult &result, const vector<MysqlColumnReader> &readers, DataChunk &output)
+{
+	auto column_count = output.ColumnCount();
+	idx_t output_offset = 0;
+	while (output_offset < STANDARD_VECTOR_SIZE)
+	{
+		for (idx_t col_idx = 0; col_idx < column_count; col_idx++)
+		{
+			auto &column = result.columns[col_idx];
+			if (column.fixed_width)
+			{
+				auto data = FlatVector::GetData<data_t>(output.data[col_idx]);
+				result.binds[col_idx].buffer = data + output_offset * column.value_size;
+			}
+		}
+		if (mysql_stmt_bind_result(result.stmt, result.binds.data()))
+		{
+			throw IOException("Unable to bind MySQL result: %s", mysql_stmt_error(result.stmt));
+		}
+
+		auto status = mysql_stmt_fetch(result.stmt);
+		if (status == MYSQL_NO_DATA)
+		{
+			break;
+		}
+		if (status == 1)
+		{
+			throw IOException("Unable to fetch MySQL row: %s", mysql_stmt_error(result.stmt));
+		}
+
+		for (idx_t col_idx = 0; col_idx < column_count; col_idx++)
+		{
+			auto &column = result.columns[col_idx];
+			auto &out_vec = output.data[col_idx];
+			if (column.is_null)
+			{
+				FlatVector::SetNull(out_vec, output_offset, true);
+				continue;
+			}
+			if (column.fixed_width)
+			{
+				continue;
+			}
+			if (column.temporal)
+			{
+				MysqlNativeStoreTemporal(out_vec, readers[col_idx].type, column.time_value, output_offset);
+				continue;
+			}
+			auto &bind = result.binds[col_idx];
+			if (column.direct_string)
+			{
+				MysqlNativeStoreString(result, column, bind, col_idx, out_vec, output_offset);
+				continue;
+			}
+			if (column.length > column.buffer.size())
+			{
+				// the value did not fit the scratch buffer, grow it and read the column again
+				column.buffer.resize(column.length);
+				bind.buffer = column.buffer.data();
+				bind.buffer_length = column.buffer.size();
+				if (mysql_stmt_fetch_column(result.stmt, &bind, col_idx, 0) != 0)
+				{
+					throw IOException("Unable to fetch MySQL column: %s", mysql_stmt_error(result.stmt));
+				}
+			}
+			MysqlNativeStoreText(out_vec, readers[col_idx].type, column.buffer.data(), column.length, output_offset);
+		}
+		output_offset++;
+	}
+	return output_offset;
+}
@@ -0,0 +1,788 @@
+#pragma once
+#include "duckdb.hpp"
+
+#include "../state/mysql_binlog_state.hpp"
+#include "mysql_binary_to_duckdb_result.cpp"
+#include "duckdb/common/types/blob.hpp"
+
+#include <cstring>
+
+using namespace duckdb;
+
+// Types of the binlog events the binlog table function handles
+enum class MysqlBinlogEventType : uint8_t
+{
+	QUERY = 2,
+	ROTATE = 4,
+	FORMAT_DESCRIPTION = 15,
+	XID = 16,
+	TABLE_MAP = 19,
+	WRITE_ROWS_V1 = 23,
+	UPDATE_ROWS_V1 = 24,
+	DELETE_ROWS_V1 = 25,
+	WRITE_ROWS = 30,
+	UPDATE_ROWS = 31,
+	DELETE_ROWS = 32,
+	GTID = 33,
+	PARTIAL_UPDATE_ROWS = 39
+};
+
+#define MYSQL_BINLOG_HEADER_SIZE 19
+#define MYSQL_BINLOG_CHECKSUM_SIZE 4
+
+// Reads the little endian integers and the length prefixed values an event is made of, checking its bounds
+struct MysqlBinlogReader
+{
+	MysqlBinlogReader(const uint8_t *data, idx_t size) : data(data), size(size)
+	{
+	}
+
+	const uint8_t *data;
+	idx_t size;
+	idx_t pos = 0;
+
+	void Check(idx_t count) const
+	{
+		if (pos + count > size)
+		{
+			throw IOException("Truncated MySQL binlog event");
+		}
+	}
+
+	uint64_t ReadLE(idx_t count)
+	{
+		Check(count);
+		uint64_t result = 0;
+		for (idx_t i = 0; i < count; i++)
+		{
+			result |= (uint64_t)data[pos + i] << (8 * i);
+		}
+		pos += count;
+		return result;
+	}
+
+	// temporal values are stored big endian, so that they compare as bytes
+	uint64_t ReadBE(idx_t count)
+	{
+		Check(count);
+		uint64_t result = 0;
+		for (idx_t i = 0; i < count; i++)
+		{
+			result = (result << 8) | data[pos + i];
+		}
+		pos += count;
+		return result;
+	}
+
+	// length encoded integer of the client/server protocol
+	uint64_t ReadPackedInt()
+	{
+		auto first = ReadLE(1);
+		switch (first)
+		{
+		case 252:
+			return ReadLE(2);
+		case 253:
+			return ReadLE(3);
+		case 254:
+			return ReadLE(8);
+		default:
+			return first;
+		}
+	}
+
+	const char *ReadBytes(idx_t count)
+	{
+		Check(count);
+		auto result = (const char *)data + pos;
+		pos += count;
+		return result;
+	}
+
+	void Skip(idx_t count)
+	{
+		ReadBytes(count);
+	}
+
+	idx_t Remaining() const
+	{
+		return size - pos;
+	}
+};
+
+// Number of bytes of the metadata of a column type in a table map event
+static idx_t MysqlBinlogMetadataSize(uint8_t type)
+{
+	switch (type)
+	{
+	case MYSQL_TYPE_FLOAT:
+	case MYSQL_TYPE_DOUBLE:
+	case MYSQL_TYPE_BLOB:
+	case MYSQL_TYPE_TINY_BLOB:
+	case MYSQL_TYPE_MEDIUM_BLOB:
+	case MYSQL_TYPE_LONG_BLOB:
+	case MYSQL_TYPE_GEOMETRY:
+	case MYSQL_TYPE_JSON:
+	case MYSQL_TYPE_TIME2:
+	case MYSQL_TYPE_DATETIME2:
+	case MYSQL_TYPE_TIMESTAMP2:
+		return 1;
+	case MYSQL_TYPE_VARCHAR:
+	case MYSQL_TYPE_VAR_STRING:
+	case MYSQL_TYPE_STRING:
+	case MYSQL_TYPE_NEWDECIMAL:
+	case MYSQL_TYPE_BIT:
+	case MYSQL_TYPE_ENUM:
+	case MYSQL_TYPE_SET:
+		return 2;
+	default:
+		return 0;
+	}
+}
+
+static void MysqlBinlogStoreInteger(Vector &out_vec, const LogicalType &type, int64_t value, bool is_unsigned, idx_t row)
+{
+	// the scans read unsigned columns into the signed types as well, the values past their range wrap around
+	switch (type.id())
+	{
+	case LogicalTypeId::TINYINT:
+		FlatVector::GetData<int8_t>(out_vec)[row] = (int8_t)value;
+		break;
+	case LogicalTypeId::SMALLINT:
+		FlatVector::GetData<int16_t>(out_vec)[row] = (int16_t)value;
+		break;
+	case LogicalTypeId::INTEGER:
+		FlatVector::GetData<int32_t>(out_vec)[row] = (int32_t)value;
+		break;
+	case LogicalTypeId::BIGINT:
+		FlatVector::GetData<int64_t>(out_vec)[row] = value;
+		break;
+	default:
+		out_vec.SetValue(row, (is_unsigned ? Value::UBIGINT((uint64_t)value) : Value::BIGINT(value)).DefaultCastAs(type));
+		break;
+	}
+}
+
+static void MysqlBinlogStoreDouble(Vector &out_vec, const LogicalType &type, double value, idx_t row)
+{
+	switch (type.id())
+	{
+	case LogicalTypeId::FLOAT:
+		FlatVector::GetData<float>(out_vec)[row] = (float)value;
+		break;
+	case LogicalTypeId::DOUBLE:
+		FlatVector::GetData<double>(out_vec)[row] = value;
+		break;
+	default:
+		out_vec.SetValue(row, Value::DOUBLE(value).DefaultCastAs(type));
+		break;
+	}
+}
+
+static void MysqlBinlogStoreTemporal(Vector &out_vec, const LogicalType &type, const MYSQL_TIME &value, idx_t row)
+{
+	switch (type.id())
+	{
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+		MysqlNativeStoreTemporal(out_vec, type, value, row);
+		break;
+	default:
+	{
+		// the text MySQL would send for the value
+		auto text = StringUtil::Format("%04d-%02d-%02d %02d:%02d:%02d.%06d", value.year, value.month, value.day, value.hour,
+																	 value.minute, value.second, value.second_part);
+		MysqlNativeStoreText(out_vec, type, text.c_str(), text.size(), row);
+		break;
+	}
+	}
+}
+
+// Fractional seconds of TIME2, DATETIME2 and TIMESTAMP2 values, stored on (fsp + 1) / 2 big endian bytes
+static int64_t MysqlBinlogReadMicros(MysqlBinlogReader &reader, uint8_t fsp)
+{
+	switch (fsp)
+	{
+	case 1:
+	case 2:
+		return reader.ReadBE(1) * 10000;
+	case 3:
+	case 4:
+		return reader.ReadBE(2) * 100;
+	case 5:
+	case 6:
+		return reader.ReadBE(3);
+	default:
+		return 0;
+	}
+}
+
+static MYSQL_TIME MysqlBinlogDate(int64_t year, int64_t month, int64_t day)
+{
+	MYSQL_TIME result;
+	memset(&result, 0, sizeof(result));
+	result.year = year;
+	result.month = month;
+	result.day = day;
+	result.time_type = MYSQL_TIMESTAMP_DATE;
+	return result;
+}
+
+// Text of a binary DECIMAL: groups of 9 digits on 4 bytes, the leading and trailing partial groups on fewer bytes,
+// big endian, with the sign in the first bit and the negative values stored inverted
+static string MysqlBinlogDecimalText(MysqlBinlogReader &reader, uint8_t precision, uint8_t scale)
+{
+	static const idx_t digits_bytes[] = {0, 1, 1, 2, 2, 3, 3, 4, 4, 4};
+	auto integral = precision - scale;
+	auto integral_groups = integral / 9;
+	auto integral_digits = integral % 9;
+	auto fraction_groups = scale / 9;
+	auto fraction_digits = scale % 9;
+	auto size = integral_groups * 4 + digits_bytes[integral_digits] + fraction_groups * 4 + digits_bytes[fraction_digits];
+
+	auto bytes = reader.ReadBytes(size);
+	string value(bytes, size);
+	auto negative = !(value[0] & 0x80);
+	value[0] ^= 0x80;
+	if (negative)
+	{
+		for (auto &c : value)
+		{
+			c = ~c;
+		}
+	}
+	MysqlBinlogReader digits((const uint8_t *)value.data(), value.size());
+
+	string integral_text;
+	if (integral_digits > 0)
+	{
+		integral_text += std::to_string(digits.ReadBE(digits_bytes[integral_digits]));
+	}
+	for (idx_t group = 0; group < (idx_t)integral_groups; group++)
+	{
+		auto group_text = std::to_string(digits.ReadBE(4));
+		integral_text += string(9 - group_text.size(), '0') + group_text;
+	}
+	auto first_digit = integral_text.find_first_not_of('0');
+	integral_text = first_digit == string::npos ? "0" : integral_text.substr(first_digit);
+
+	string fraction_text;
+	for (idx_t group = 0; group < (idx_t)fraction_groups; group++)
+	{
+		auto group_text = std::to_string(digits.ReadBE(4));
+		fraction_text += string(9 - group_text.size(), '0') + group_text;
+	}
+	if (fraction_digits > 0)
+	{
+		auto group_text = std::to_string(digits.ReadBE(digits_bytes[fraction_digits]));
+		fraction_text += string(fraction_digits - group_text.size(), '0') + group_text;
+	}
+	auto result = (negative ? "-" : "") + integral_text;
+	return fraction_text.empty() ? result : result + "." + fraction_text;
+}
+
+static void MysqlBinlogAppendJsonString(string &result, const char *data, idx_t length)
+{
+	result += '"';
+	for (idx_t i = 0; i < length; i++)
+	{
+		auto c = data[i];
+		switch (c)
+		{
+		case '"':
+			result += "\\\"";
+			break;
+		case '\\':
+			result += "\\\\";
+			break;
+		case '\n':
+			result += "\\n";
+			break;
+		case '\r':
+			result += "\\r";
+			break;
+		case '\t':
+			result += "\\t";
+			break;
+		default:
+			if ((uint8_t)c < 0x20)
+			{
+				result += StringUtil::Format("\\u%04x", (int)c);
+			}
+			else
+			{
+				result += c;
+			}
+		}
+	}
+	result += '"';
+}
+
+// Length of the strings of the binary JSON format, 7 bits per byte, the high bit telling whether more follow
+static uint64_t MysqlBinlogJsonLength(MysqlBinlogReader &reader)
+{
+	uint64_t length = 0;
+	for (idx_t shift = 0; shift < 35; shift += 7)
+	{
+		auto byte = reader.ReadLE(1);
+		length |= (byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+		{
+			return length;
+		}
+	}
+	throw IOException("Malformed JSON value in MySQL binlog event");
+}
+
+static void MysqlBinlogJsonValue(const uint8_t *data, idx_t size, uint8_t type, string &result);
+
+// Objects and arrays: element count and size, the keys of an object, then one entry per value holding its type
+// and either the value itself (small scalars) or its offset, offsets being relative to the start of the container
+static void MysqlBinlogJsonContainer(const uint8_t *data, idx_t size, bool object, bool large, string &result)
+{
+	auto offset_size = large ? 4 : 2;
+	MysqlBinlogReader reader(data, size);
+	auto count = reader.ReadLE(offset_size);
+	reader.Skip(offset_size);
+	auto key_entries = reader.pos;
+	auto value_entries = key_entries + (object ? count * (offset_size + 2) : 0);
+	auto value_entry_size = 1 + offset_size;
+
+	result += object ? '{' : '[';
+	for (idx_t i = 0; i < count; i++)
+	{
+		if (i > 0)
+		{
+			result += ',';
+		}
+		if (object)
+		{
+			MysqlBinlogReader key(data, size);
+			key.pos = key_entries + i * (offset_size + 2);
+			auto key_offset = key.ReadLE(offset_size);
+			auto key_length = key.ReadLE(2);
+			key.pos = key_offset;
+			MysqlBinlogAppendJsonString(result, key.ReadBytes(key_length), key_length);
+			result += ':';
+		}
+		MysqlBinlogReader entry(data, size);
+		entry.pos = value_entries + i * value_entry_size;
+		auto value_type = (uint8_t)entry.ReadLE(1);
+		auto inlined = value_type == 0x04 || value_type == 0x05 || value_type == 0x06 ||
+									 (large && (value_type == 0x07 || value_type == 0x08));
+		if (inlined)
+		{
+			MysqlBinlogJsonValue(data + entry.pos, offset_size, value_type, result);
+		}
+		else
+		{
+			auto value_offset = entry.ReadLE(offset_size);
+			if (value_offset >= size)
+			{
+				throw IOException("Malformed JSON value in MySQL binlog event");
+			}
+			MysqlBinlogJsonValue(data + value_offset, size - value_offset, value_type, result);
+		}
+	}
+	result += object ? '}' : ']';
+}
+
+// Renders a value of the binary JSON format as JSON text
+static void MysqlBinlogJsonValue(const uint8_t *data, idx_t size, uint8_t type, string &result)
+{
+	MysqlBinlogReader reader(data, size);
+	switch (type)
+	{
+	case 0x00:
+	case 0x01:
+	case 0x02:
+	case 0x03:
+		MysqlBinlogJsonContainer(data, size, type <= 0x01, type == 0x01 || type == 0x03, result);
+		break;
+	case 0x04:
+	{
+		auto literal = reader.ReadLE(1);
+		result += literal == 0x01 ? "true" : literal == 0x02 ? "false" : "null";
+		break;
+	}
+	case 0x05:
+		result += std::to_string((int16_t)reader.ReadLE(2));
+		break;
+	case 0x06:
+		result += std::to_string((uint16_t)reader.ReadLE(2));
+		break;
+	case 0x07:
+		result += std::to_string((int32_t)reader.ReadLE(4));
+		break;
+	case 0x08:
+		result += std::to_string((uint32_t)reader.ReadLE(4));
+		break;
+	case 0x09:
+		result += std::to_string((int64_t)reader.ReadLE(8));
+		break;
+	case 0x0A:
+		result += std::to_string(reader.ReadLE(8));
+		break;
+	case 0x0B:
+	{
+		double value;
+		memcpy(&value, reader.ReadBytes(sizeof(double)), sizeof(double));
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%.17g", value);
+		result += buffer;
+		break;
+	}
+	case 0x0C:
+	{
+		auto length = MysqlBinlogJsonLength(reader);
+		MysqlBinlogAppendJsonString(result, reader.ReadBytes(length), length);
+		break;
+	}
+	case 0x0F:
+	{
+		// values of other MySQL types (DECIMAL, DATETIME...) in their internal format, rendered the way MySQL
+		// renders the ones it can not convert
+		auto field_type = reader.ReadLE(1);
+		auto length = MysqlBinlogJsonLength(reader);
+		auto bytes = string_t(reader.ReadBytes(length), length);
+		string base64(Blob::ToBase64Size(bytes), '\0');
+		Blob::ToBase64(bytes, (char *)base64.data());
+		auto text = StringUtil::Format("base64:type%d:%s", (int)field_type, base64);
+		MysqlBinlogAppendJsonString(result, text.c_str(), text.size());
+		break;
+	}
+	default:
+		throw IOException("Unsupported JSON type %d in MySQL binlog event", (int)type);
+	}
+}
+
+// Decodes the value of a column from a row image into the output vector
+static void MysqlBinlogStoreValue(MysqlBinlogReader &reader, const MysqlBinlogColumn &column, Vector &out_vec,
+																	const LogicalType &type, idx_t row)
+{
+	auto type_id = column.type;
+	auto meta0 = column.meta0;
+	auto meta1 = column.meta1;
+	if (type_id == MYSQL_TYPE_STRING && (meta0 == MYSQL_TYPE_ENUM || meta0 == MYSQL_TYPE_SET))
+	{
+		// the real type of ENUM and SET columns is in the metadata, along with their size
+		type_id = meta0;
+	}
+
+	switch (type_id)
+	{
+	case MYSQL_TYPE_TINY:
+	{
+		auto value = reader.ReadLE(1);
+		MysqlBinlogStoreInteger(out_vec, type, column.is_unsigned ? (int64_t)value : (int8_t)value, column.is_unsigned, row);
+		break;
+	}
+	case MYSQL_TYPE_SHORT:
+	{
+		auto value = reader.ReadLE(2);
+		MysqlBinlogStoreInteger(out_vec, type, column.is_unsigned ? (int64_t)value : (int16_t)value, column.is_unsigned, row);
+		break;
+	}
+	case MYSQL_TYPE_INT24:
+	{
+		auto value = reader.ReadLE(3);
+		// sign extension of the 24 bits
+		auto signed_value = (int64_t)(value ^ 0x800000) - 0x800000;
+		MysqlBinlogStoreInteger(out_vec, type, column.is_unsigned ? (int64_t)value : signed_value, column.is_unsigned, row);
+		break;
+	}
+	case MYSQL_TYPE_LONG:
+	{
+		auto value = reader.ReadLE(4);
+		MysqlBinlogStoreInteger(out_vec, type, column.is_unsigned ? (int64_t)value : (int32_t)value, column.is_unsigned, row);
+		break;
+	}
+	case MYSQL_TYPE_LONGLONG:
+		MysqlBinlogStoreInteger(out_vec, type, (int64_t)reader.ReadLE(8), column.is_unsigned, row);
+		break;
+	case MYSQL_TYPE_YEAR:
+	{
+		auto value = reader.ReadLE(1);
+		MysqlBinlogStoreInteger(out_vec, type, value == 0 ? 0 : 1900 + value, false, row);
+		break;
+	}
+	case MYSQL_TYPE_FLOAT:
+	{
+		float value;
+		memcpy(&value, reader.ReadBytes(sizeof(float)), sizeof(float));
+		MysqlBinlogStoreDouble(out_vec, type, value, row);
+		break;
+	}
+	case MYSQL_TYPE_DOUBLE:
+	{
+		double value;
+		memcpy(&value, reader.ReadBytes(sizeof(double)), sizeof(double));
+		MysqlBinlogStoreDouble(out_vec, type, value, row);
+		break;
+	}
+	case MYSQL_TYPE_NEWDECIMAL:
+	{
+		auto text = MysqlBinlogDecimalText(reader, meta0, meta1);
+		MysqlNativeStoreText(out_vec, type, text.c_str(), text.size(), row);
+		break;
+	}
+	case MYSQL_TYPE_DATE:
+	{
+		auto value = reader.ReadLE(3);
+		MysqlBinlogStoreTemporal(out_vec, type, MysqlBinlogDate(value >> 9, (value >> 5) & 15, value & 31), row);
+		break;
+	}
+	case MYSQL_TYPE_TIME:
+	case MYSQL_TYPE_TIME2:
+	{
+		int64_t hours, minutes, seconds, micros = 0;
+		bool negative;
+		if (type_id == MYSQL_TYPE_TIME)
+		{
+			// before MySQL 5.6.4: HHMMSS as a signed 24 bits integer
+			auto value = (int64_t)(reader.ReadLE(3) ^ 0x800000) - 0x800000;
+			negative = value < 0;
+			value = negative ? -value : value;
+			hours = value / 10000;
+			minutes = value / 100 % 100;
+			seconds = value % 100;
+		}
+		else
+		{
+			// 1 bit sign, 10 bits hours, 6 bits minutes, 6 bits seconds then the fraction, offset to be unsigned
+			int64_t packed;
+			if (meta0 >= 5)
+			{
+				packed = (int64_t)reader.ReadBE(6) - 0x800000000000LL;
+			}
+			else
+			{
+				int64_t integral = (int64_t)reader.ReadBE(3) - 0x800000;
+				int64_t fraction = 0;
+				if (meta0 >= 1)
+				{
+					auto fraction_bytes = meta0 >= 3 ? 2 : 1;
+					fraction = reader.ReadBE(fraction_bytes);
+					if (integral < 0 && fraction != 0)
+					{
+						// negative values store the complement of the fraction
+						integral++;
+						fraction -= fraction_bytes == 2 ? 0x10000 : 0x100;
+					}
+					fraction *= fraction_bytes == 2 ? 100 : 10000;
+				}
+				packed = integral * (1LL << 24) + fraction;
+			}
+			negative = packed < 0;
+			packed = negative ? -packed : packed;
+			auto integral = packed >> 24;
+			micros = packed % (1LL << 24);
+			hours = (integral >> 12) % (1 << 10);
+			minutes = (integral >> 6) % (1 << 6);
+			seconds = integral % (1 << 6);
+		}
+		MYSQL_TIME value;
+		memset(&value, 0, sizeof(value));
+		value.neg = negative;
+		value.hour = hours;
+		value.minute = minutes;
+		value.second = seconds;
+		value.second_part = micros;
+		value.time_type = MYSQL_TIMESTAMP_TIME;
+		MysqlBinlogStoreTemporal(out_vec, type, value, row);
+		break;
+	}
+	case MYSQL_TYPE_DATETIME:
+	{
+		// before MySQL 5.6.4: YYYYMMDDHHMMSS as an integer
+		auto packed = reader.ReadLE(8);
+		auto date = packed / 1000000;
+		auto time = packed % 1000000;
+		auto value = MysqlBinlogDate(date / 10000, date / 100 % 100, date % 100);
+		value.hour = time / 10000;
+		value.minute = time / 100 % 100;
+		value.second = time % 100;
+		value.time_type = MYSQL_TIMESTAMP_DATETIME;
+		MysqlBinlogStoreTemporal(out_vec, type, value, row);
+		break;
+	}
+	case MYSQL_TYPE_DATETIME2:
+	{
+		// 1 bit sign, 17 bits year * 13 + month, 5 bits day, 5 bits hour, 6 bits minute, 6 bits second
+		auto packed = (int64_t)reader.ReadBE(5) - 0x8000000000LL;
+		auto micros = MysqlBinlogReadMicros(reader, meta0);
+		auto year_month = (packed >> 22) % (1 << 17);
+		auto value = MysqlBinlogDate(year_month / 13, year_month % 13, (packed >> 17) % (1 << 5));
+		value.hour = (packed >> 12) % (1 << 5);
+		value.minute = (packed >> 6) % (1 << 6);
+		value.second = packed % (1 << 6);
+		value.second_part = micros;
+		value.time_type = MYSQL_TIMESTAMP_DATETIME;
+		MysqlBinlogStoreTemporal(out_vec, type, value, row);
+		break;
+	}
+	case MYSQL_TYPE_TIMESTAMP:
+	case MYSQL_TYPE_TIMESTAMP2:
+	{
+		// seconds since the epoch in UTC, 0 being the zero timestamp
+		auto seconds = type_id == MYSQL_TYPE_TIMESTAMP ? (int64_t)reader.ReadLE(4) : (int64_t)reader.ReadBE(4);
+		auto micros = type_id == MYSQL_TYPE_TIMESTAMP ? 0 : MysqlBinlogReadMicros(reader, meta0);
+		if (seconds == 0 && micros == 0)
+		{
+			FlatVector::SetNull(out_vec, row, true);
+			break;
+		}
+		auto timestamp = Timestamp::FromEpochMicroSeconds(seconds * Interval::MICROS_PER_SEC + micros);
+		if (type.id() == LogicalTypeId::TIMESTAMP)
+		{
+			FlatVector::GetData<timestamp_t>(out_vec)[row] = timestamp;
+		}
+		else
+		{
+			out_vec.SetValue(row, Value::TIMESTAMP(timestamp).DefaultCastAs(type));
+		}
+		break;
+	}
+	case MYSQL_TYPE_ENUM:
+	{
+		// 1 based index of the member, 0 for the empty string of invalid values
+		auto index = reader.ReadLE(meta1);
+		if (index == 0)
+		{
+			FlatVector::SetNull(out_vec, row, true);
+			break;
+		}
+		switch (type.InternalType())
+		{
+		case PhysicalType::UINT8:
+			FlatVector::GetData<uint8_t>(out_vec)[row] = (uint8_t)(index - 1);
+			break;
+		case PhysicalType::UINT16:
+			FlatVector::GetData<uint16_t>(out_vec)[row] = (uint16_t)(index - 1);
+			break;
+		case PhysicalType::UINT32:
+			FlatVector::GetData<uint32_t>(out_vec)[row] = (uint32_t)(index - 1);
+			break;
+		default:
+			out_vec.SetValue(row, Value::UBIGINT(index));
+			break;
+		}
+		break;
+	}
+	case MYSQL_TYPE_SET:
+	{
+		// one bit per member, rendered as MySQL does: the members separated by commas
+		auto bits = reader.ReadLE(meta1);
+		vector<string> members;
+		for (idx_t member = 0; member < column.set_members.size(); member++)
+		{
+			if (bits & (1ULL << member))
+			{
+				members.push_back(column.set_members[member]);
+			}
+		}
+		auto text = StringUtil::Join(members, ",");
+		MysqlNativeStoreText(out_vec, type, text.c_str(), text.size(), row);
+		break;
+	}
+	case MYSQL_TYPE_BIT:
+	{
+		auto bit_count = meta1 * 8 + meta0;
+		auto bytes = (const uint8_t *)reader.ReadBytes((bit_count + 7) / 8);
+		string text;
+		for (idx_t bit = 0; bit < (idx_t)bit_count; bit++)
+		{
+			// big endian, the first byte only holds the remaining bits
+			auto position = (idx_t)(bit_count - 1 - bit);
+			auto byte = bytes[(bit_count + 7) / 8 - 1 - position / 8];
+			text += (byte >> (position % 8)) & 1 ? '1' : '0';
+		}
+		MysqlNativeStoreText(out_vec, type, text.c_str(), text.size(), row);
+		break;
+	}
+	case MYSQL_TYPE_VARCHAR:
+	case MYSQL_TYPE_VAR_STRING:
+	case MYSQL_TYPE_STRING:
+	{
+		idx_t max_length = type_id == MYSQL_TYPE_STRING ? (((meta0 & 0x30) ^ 0x30) << 4) | meta1 : meta0 | (meta1 << 8);
+		auto length = reader.ReadLE(max_length < 256 ? 1 : 2);
+		MysqlNativeStoreText(out_vec, type, reader.ReadBytes(length), length, row);
+		break;
+	}
+	case MYSQL_TYPE_BLOB:
+	case MYSQL_TYPE_TINY_BLOB:
+	case MYSQL_TYPE_MEDIUM_BLOB:
+	case MYSQL_TYPE_LONG_BLOB:
+	case MYSQL_TYPE_GEOMETRY:
+	{
+		auto length = reader.ReadLE(meta0);
+		MysqlNativeStoreText(out_vec, type, reader.ReadBytes(length), length, row);
+		break;
+	}
+	case MYSQL_TYPE_JSON:
+	{
+		auto length = reader.ReadLE(meta0);
+		auto data = (const uint8_t *)reader.ReadBytes(length);
+		string text;
+		if (length == 0)
+		{
+			text = "null";
+		}
+		else
+		{
+			MysqlBinlogJsonValue(data + 1, length - 1, data[0], text);
+		}
+		MysqlNativeStoreText(out_vec, type, text.c_str(), text.size(), row);
+		break;
+	}
+	default:
+		throw NotImplementedException("Unsupported MySQL binlog column type %d", (int)type_id);
+	}
+}
+
+// Decodes one row image into the next row of the pending chunk: a NULL bitmap over the columns present in the
+// image, then the values of the present non NULL columns. Columns left out of the image are NULL.
+static void MysqlBinlogReadRow(MysqlBinlogReader &reader, const vector<MysqlBinlogColumn> &columns,
+															 const vector<bool> &present, const string &op, DataChunk &pending)
+{
+	auto row = pending.size();
+	FlatVector::GetData<string_t>(pending.data[0])[row] = StringVector::AddString(pending.data[0], op);
+
+	idx_t present_count = 0;
+	for (auto is_present : present)
+	{
+		present_count += is_present;
+	}
+	auto null_bits = (const uint8_t *)reader.ReadBytes((present_count + 7) / 8);
+	idx_t present_idx = 0;
+	for (idx_t col_idx = 0; col_idx < columns.size(); col_idx++)
+	{
+		auto &out_vec = pending.data[col_idx + 1];
+		if (!present[col_idx])
+		{
+			FlatVector::SetNull(out_vec, row, true);
+			continue;
+		}
+		auto is_null = null_bits[present_idx / 8] & (1 << (present_idx % 8));
+		present_idx++;
+		if (is_null)
+		{
+			FlatVector::SetNull(out_vec, row, true);
+			continue;
+		}
+		MysqlBinlogStoreValue(reader, columns[col_idx], out_vec, out_vec.GetType(), row);
+	}
+	pending.SetCardinality(row + 1);
+}
+
+static vector<bool> MysqlBinlogReadBitmap(MysqlBinlogReader &reader, idx_t count)
+{
+	auto bytes = (const uint8_t *)reader.ReadBytes((count + 7) / 8);
+	vector<bool> result(count);
+	for (idx_t i = 0; i < count; i++)
+	{
+		result[i] = bytes[i / 8] & (1 << (i % 8));
+	}
+	return result;
+}
@@ -1,3 +1,4 @@
+#pragma once
 #include "duckdb.hpp"
 
 #include "../model/mysql_bind_data.hpp"
@@ -6,7 +7,6 @@
 #include <iostream>
 #include <chrono>
 #include <sstream>
-#include <ctime>
 
 using namespace duckdb;
 
@@ -57,6 +57,11 @@ static LogicalType DuckDBType2(MysqlTypeInfo *type_info)
 	}
 	else if (mysql_type_name == "decimal")
 	{
+		// MySQL allows up to 65 digits, DuckDB 38
+		if (type_info->numeric_precision > Decimal::MAX_WIDTH_DECIMAL)
+		{
+			return LogicalType::DOUBLE;
+		}
 		return LogicalType::DECIMAL(type_info->numeric_precision, type_info->numeric_scale);
 	}
 	else if (mysql_type_name == "char" || mysql_type_name == "bpchar" || mysql_type_name == "varchar" || mysql_type_name == "text" ||
@@ -80,10 +85,14 @@ static LogicalType DuckDBType2(MysqlTypeInfo *type_info)
 	{
 		return LogicalType::TIME_TZ;
 	}
-	else if (mysql_type_name == "timestamp")
+	else if (mysql_type_name == "timestamp" || mysql_type_name == "datetime")
 	{
 		return LogicalType::TIMESTAMP;
 	}
+	else if (mysql_type_name == "year")
+	{
+		return LogicalType::INTEGER;
+	}
 	else if (mysql_type_name == "timestamptz")
 	{
 		return LogicalType::TIMESTAMP_TZ;
@@ -107,14 +116,323 @@ static LogicalType DuckDBType(MysqlColumnInfo &info)
 	return DuckDBType2(&info.type_info);
 }
 
-static std::chrono::system_clock::time_point parseTimestamp(const std::string& timestampStr) {
-    std::tm tm = {};
-    if (strptime(timestampStr.c_str(), "%Y-%m-%d %H:%M:%S", &tm) == nullptr) {
-        throw std::invalid_argument("Invalid timestamp format");
-    }
+// Parsers of the text form MySQL sends temporal values in: fixed width fields, read in place without allocating
+// and without any timezone conversion. They return false for the values DuckDB has no counterpart for
+// (the zero dates, times outside of a day), which are read as NULL, and throw on malformed text.
+
+static inline bool MysqlParseDigits(const char *data, idx_t length, idx_t &pos, idx_t count, int32_t &result)
+{
+	if (pos + count > length)
+	{
+		return false;
+	}
+	result = 0;
+	for (idx_t end = pos + count; pos < end; pos++)
+	{
+		if (data[pos] < '0' || data[pos] > '9')
+		{
+			return false;
+		}
+		result = result * 10 + (data[pos] - '0');
+	}
+	return true;
+}
+
+static inline bool MysqlParseSeparator(const char *data, idx_t length, idx_t &pos, char separator)
+{
+	if (pos >= length || data[pos] != separator)
+	{
+		return false;
+	}
+	pos++;
+	return true;
+}
+
+// Up to 6 fractional digits after an optional '.', as microseconds
+static inline bool MysqlParseMicros(const char *data, idx_t length, idx_t &pos, int32_t &micros)
+{
+	micros = 0;
+	if (pos == length)
+	{
+		return true;
+	}
+	if (data[pos] != '.')
+	{
+		return false;
+	}
+	pos++;
+	idx_t digits = 0;
+	for (; pos < length && digits < 6; pos++, digits++)
+	{
+		if (data[pos] < '0' || data[pos] > '9')
+		{
+			return false;
+		}
+		micros = micros * 10 + (data[pos] - '0');
+	}
+	for (; digits < 6; digits++)
+	{
+		micros *= 10;
+	}
+	return pos == length;
+}
+
+// YYYY-MM-DD, the date part is also the prefix of a DATETIME
+static bool MysqlParseDatePart(const char *data, idx_t length, idx_t &pos, int32_t &year, int32_t &month, int32_t &day)
+{
+	if (!MysqlParseDigits(data, length, pos, 4, year) || !MysqlParseSeparator(data, length, pos, '-') ||
+			!MysqlParseDigits(data, length, pos, 2, month) || !MysqlParseSeparator(data, length, pos, '-') ||
+			!MysqlParseDigits(data, length, pos, 2, day))
+	{
+		throw InvalidInputException("Invalid MySQL date \"%s\"", string(data, length));
+	}
+	return month != 0 && day != 0 && Date::IsValid(year, month, day);
+}
+
+static bool MysqlParseDate(const char *data, idx_t length, date_t &result)
+{
+	idx_t pos = 0;
+	int32_t year, month, day;
+	if (!MysqlParseDatePart(data, length, pos, year, month, day))
+	{
+		return false;
+	}
+	if (pos != length)
+	{
+		throw InvalidInputException("Invalid MySQL date \"%s\"", string(data, length));
+	}
+	result = Date::FromDate(year, month, day);
+	return true;
+}
+
+// [-]H..H:MM:SS[.ffffff], TIME values range from -838:59:59 to 838:59:59 while a DuckDB TIME is within a day
+static bool MysqlParseTime(const char *data, idx_t length, dtime_t &result)
+{
+	idx_t pos = 0;
+	auto negative = MysqlParseSeparator(data, length, pos, '-');
+	int32_t hour = 0;
+	auto hour_start = pos;
+	while (pos < length && data[pos] >= '0' && data[pos] <= '9')
+	{
+		hour = hour * 10 + (data[pos] - '0');
+		pos++;
+	}
+	int32_t minute, second, micros;
+	if (pos == hour_start || pos - hour_start > 3 || !MysqlParseSeparator(data, length, pos, ':') ||
+			!MysqlParseDigits(data, length, pos, 2, minute) || !MysqlParseSeparator(data, length, pos, ':') ||
+			!MysqlParseDigits(data, length, pos, 2, second) || !MysqlParseMicros(data, length, pos, micros))
+	{
+		throw InvalidInputException("Invalid MySQL time \"%s\"", string(data, length));
+	}
+	if (negative || hour >= Interval::HOURS_PER_DAY)
+	{
+		return false;
+	}
+	result = Time::FromTime(hour, minute, second, micros);
+	return true;
+}
+
+// YYYY-MM-DD HH:MM:SS[.ffffff], for DATETIME and TIMESTAMP columns alike
+static bool MysqlParseTimestamp(const char *data, idx_t length, timestamp_t &result)
+{
+	idx_t pos = 0;
+	int32_t year, month, day, hour, minute, second, micros;
+	auto valid = MysqlParseDatePart(data, length, pos, year, month, day);
+	if (!MysqlParseSeparator(data, length, pos, ' ') || !MysqlParseDigits(data, length, pos, 2, hour) ||
+			!MysqlParseSeparator(data, length, pos, ':') || !MysqlParseDigits(data, length, pos, 2, minute) ||
+			!MysqlParseSeparator(data, length, pos, ':') || !MysqlParseDigits(data, length, pos, 2, second) ||
+			!MysqlParseMicros(data, length, pos, micros))
+	{
+		throw InvalidInputException("Invalid MySQL timestamp \"%s\"", string(data, length));
+	}
+	if (!valid)
+	{
+		return false;
+	}
+	result = Timestamp::FromDatetime(Date::FromDate(year, month, day), Time::FromTime(hour, minute, second, micros));
+	return true;
+}
 
-    std::time_t time = std::mktime(&tm);
-    return std::chrono::system_clock::from_time_t(time);
+// Width and scale of the scaled integers MySQL DECIMAL values are read into, HUGEINT being a DECIMAL(38, 0)
+static void MysqlDecimalFormat(const LogicalType &type, uint8_t &width, uint8_t &scale)
+{
+	if (type.id() == LogicalTypeId::DECIMAL)
+	{
+		width = DecimalType::GetWidth(type);
+		scale = DecimalType::GetScale(type);
+		return;
+	}
+	width = Decimal::MAX_WIDTH_INT128;
+	scale = 0;
+}
+
+// Parses the text form of a MySQL DECIMAL ([-]digits[.digits]) in a single pass, straight into the scaled integer
+// a DuckDB DECIMAL(width, scale) is stored as. Digits are gathered 18 at a time in an int64_t, so the widths up to
+// 18 never touch T and DECIMAL(38) values need two hugeint multiplications. Fractional digits beyond the scale,
+// which MySQL only returns for computed values, are rounded half away from zero.
+template <class T>
+static T MysqlParseDecimal(const char *data, idx_t length, uint8_t width, uint8_t scale)
+{
+	idx_t pos = 0;
+	auto negative = false;
+	if (pos < length && (data[pos] == '-' || data[pos] == '+'))
+	{
+		negative = data[pos] == '-';
+		pos++;
+	}
+
+	T result = 0;
+	int64_t chunk = 0;
+	int64_t chunk_scale = 1;
+	idx_t chunk_digits = 0;
+	auto push_digit = [&](int64_t digit)
+	{
+		chunk = chunk * 10 + digit;
+		chunk_scale *= 10;
+		if (++chunk_digits == 18)
+		{
+			result = result * T(chunk_scale) + T(chunk);
+			chunk = 0;
+			chunk_scale = 1;
+			chunk_digits = 0;
+		}
+	};
+
+	idx_t integer_digits = 0;
+	auto digits_start = pos;
+	for (; pos < length && data[pos] >= '0' && data[pos] <= '9'; pos++)
+	{
+		// leading zeros do not count against the width
+		if (integer_digits == 0 && data[pos] == '0')
+		{
+			continue;
+		}
+		if (++integer_digits > (idx_t)(width - scale))
+		{
+			throw InvalidInputException("MySQL value \"%s\" does not fit DECIMAL(%d,%d)", string(data, length), width, scale);
+		}
+		push_digit(data[pos] - '0');
+	}
+	auto has_digits = pos > digits_start;
+
+	idx_t fraction_digits = 0;
+	auto round_up = false;
+	if (pos < length && data[pos] == '.')
+	{
+		pos++;
+		for (; pos < length && data[pos] >= '0' && data[pos] <= '9'; pos++, fraction_digits++)
+		{
+			if (fraction_digits < scale)
+			{
+				push_digit(data[pos] - '0');
+			}
+			else if (fraction_digits == scale)
+			{
+				round_up = data[pos] >= '5';
+			}
+		}
+		has_digits = has_digits || fraction_digits > 0;
+	}
+	if (pos != length || !has_digits)
+	{
+		throw InvalidInputException("Invalid MySQL decimal \"%s\"", string(data, length));
+	}
+	for (; fraction_digits < scale; fraction_digits++)
+	{
+		push_digit(0);
+	}
+	if (chunk_digits > 0)
+	{
+		result = result * T(chunk_scale) + T(chunk);
+	}
+	if (round_up)
+	{
+		result = result + T(1);
+		// rounding up all nines carries into one more integer digit, e.g. 99.995 as DECIMAL(4,2)
+		T limit = T(1);
+		for (idx_t digit = 0; digit < width; digit++)
+		{
+			limit = limit * T(10);
+		}
+		if (!(result < limit))
+		{
+			throw InvalidInputException("MySQL value \"%s\" does not fit DECIMAL(%d,%d)", string(data, length), width, scale);
+		}
+	}
+	return negative ? -result : result;
+}
+
+// Stores the text form of a DECIMAL (or HUGEINT) value in the storage type of the vector
+static void StoreDecimalValue(Vector &out_vec, const LogicalType &type, const char *data, idx_t length, idx_t output_offset)
+{
+	uint8_t width, scale;
+	MysqlDecimalFormat(type, width, scale);
+	switch (type.InternalType())
+	{
+	case PhysicalType::INT16:
+		FlatVector::GetData<int16_t>(out_vec)[output_offset] = MysqlParseDecimal<int16_t>(data, length, width, scale);
+		break;
+	case PhysicalType::INT32:
+		FlatVector::GetData<int32_t>(out_vec)[output_offset] = MysqlParseDecimal<int32_t>(data, length, width, scale);
+		break;
+	case PhysicalType::INT64:
+		FlatVector::GetData<int64_t>(out_vec)[output_offset] = MysqlParseDecimal<int64_t>(data, length, width, scale);
+		break;
+	case PhysicalType::INT128:
+		FlatVector::GetData<hugeint_t>(out_vec)[output_offset] = MysqlParseDecimal<hugeint_t>(data, length, width, scale);
+		break;
+	default:
+		throw InternalException("Unsupported decimal storage type %s", TypeIdToString(type.InternalType()));
+	}
+}
+
+// Stores the text form of a DATE, TIME or TIMESTAMP value
+static void StoreTemporalValue(Vector &out_vec, const LogicalType &type, const char *data, idx_t length, idx_t output_offset)
+{
+	bool valid;
+	switch (type.id())
+	{
+	case LogicalTypeId::DATE:
+		valid = MysqlParseDate(data, length, FlatVector::GetData<date_t>(out_vec)[output_offset]);
+		break;
+	case LogicalTypeId::TIME:
+		valid = MysqlParseTime(data, length, FlatVector::GetData<dtime_t>(out_vec)[output_offset]);
+		break;
+	default:
+		valid = MysqlParseTimestamp(data, length, FlatVector::GetData<timestamp_t>(out_vec)[output_offset]);
+		break;
+	}
+	if (!valid)
+	{
+		FlatVector::SetNull(out_vec, output_offset, true);
+	}
+}
+
+static void StoreEnumValue(Vector &out_vec, const LogicalType &type, const string_t &enum_val, idx_t output_offset)
+{
+	auto offset = EnumType::GetPos(type, enum_val);
+	if (offset < 0)
+	{
+		throw IOException("Could not map ENUM value %s", enum_val.GetString());
+	}
+	switch (type.InternalType())
+	{
+	case PhysicalType::UINT8:
+		FlatVector::GetData<uint8_t>(out_vec)[output_offset] = (uint8_t)offset;
+		break;
+	case PhysicalType::UINT16:
+		FlatVector::GetData<uint16_t>(out_vec)[output_offset] = (uint16_t)offset;
+		break;
+
+	case PhysicalType::UINT32:
+		FlatVector::GetData<uint32_t>(out_vec)[output_offset] = (uint32_t)offset;
+		break;
+
+	default:
+		throw InternalException("ENUM can only have unsigned integers (except "
+														"UINT64) as physical types, got %s",
+														TypeIdToString(type.InternalType()));
+	}
 }
 
 static void ProcessValue(
@@ -193,108 +511,28 @@ static void ProcessValue(
 	case LogicalTypeId::BOOLEAN:
 		FlatVector::GetData<bool>(out_vec)[output_offset] = res->getBoolean(col_idx);
 		break;
+	case LogicalTypeId::HUGEINT:
 	case LogicalTypeId::DECIMAL:
 	{
-		auto decimal_config = res->getDouble(col_idx);
-		switch (type.InternalType())
-		{
-		case PhysicalType::INT16:
-		{
-			auto smallIntValue = res->getInt(col_idx);
-			FlatVector::GetData<int16_t>(out_vec)[output_offset] = static_cast<int16_t>(smallIntValue);
-			break;
-		}
-		case PhysicalType::INT32:
-		{
-			FlatVector::GetData<int32_t>(out_vec)[output_offset] = res->getInt(col_idx);
-			break;
-		}
-		case PhysicalType::INT64:
-		{
-			FlatVector::GetData<int64_t>(out_vec)[output_offset] = res->getInt64(col_idx);
-			break;
-		}
-		// case PhysicalType::INT128:
-		// 	break;
-		default:
-			throw InvalidInputException("Unsupported decimal storage type");
-		}
+		// MySQL also returns the SUM of integer columns as a DECIMAL, read as a HUGEINT
+		auto mysql_str = res->getString(col_idx);
+		StoreDecimalValue(out_vec, type, mysql_str.c_str(), mysql_str.length(), output_offset);
 		break;
 	}
 
-//	 case LogicalTypeId::DATE:
-//	 {
-//
-//	 	auto jd = res->getUInt64(col_idx);
-//	 	auto out_ptr = FlatVector::GetData<date_t>(out_vec);
-//	 	out_ptr[output_offset].days = jd + MYSQL_EPOCH_JDATE - 2440588; // magic! TODO check as copied from Postgres
-//	 	break;
-//	 }
-
-	// case LogicalTypeId::TIME:
-	// {
-	// 	D_ASSERT(value_len == sizeof(int64_t));
-	// 	D_ASSERT(atttypmod == -1);
-
-	// 	FlatVector::GetData<dtime_t>(out_vec)[output_offset].micros = LoadEndIncrement<uint64_t>(value_ptr);
-	// 	break;
-	// }
-
-	// case LogicalTypeId::TIME_TZ:
-	// {
-	// 	D_ASSERT(value_len == sizeof(int64_t) + sizeof(int32_t));
-	// 	D_ASSERT(atttypmod == -1);
-
-	// 	auto usec = LoadEndIncrement<uint64_t>(value_ptr);
-	// 	auto tzoffset = LoadEndIncrement<int32_t>(value_ptr);
-	// 	FlatVector::GetData<dtime_t>(out_vec)[output_offset].micros = usec + tzoffset * Interval::MICROS_PER_SEC;
-	// 	break;
-	// }
-
-	 case LogicalTypeId::TIMESTAMP_TZ:
-	 case LogicalTypeId::TIMESTAMP:
-	 {
-	 	D_ASSERT(value_len == sizeof(int64_t));
-	 	D_ASSERT(atttypmod == -1);
-
-    auto ts_string = res->getString(col_idx);
-    auto ts = parseTimestamp(ts_string);
-    // Get the duration since the epoch
-    std::chrono::system_clock::duration durationSinceEpoch = ts.time_since_epoch();
-    // Convert the duration to microseconds
-    auto microsecondsSinceEpoch = std::chrono::duration_cast<std::chrono::microseconds>(durationSinceEpoch);
-    // Extract the count of microseconds
-    long long microsecondsCount = microsecondsSinceEpoch.count();
-	 	FlatVector::GetData<timestamp_t>(out_vec)[output_offset].value = microsecondsCount;
-	 	break;
-	 }
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+	case LogicalTypeId::TIMESTAMP_TZ:
+	{
+		auto mysql_str = res->getString(col_idx);
+		StoreTemporalValue(out_vec, type, mysql_str.c_str(), mysql_str.length(), output_offset);
+		break;
+	}
 	case LogicalTypeId::ENUM:
 	{
 		auto mysql_str = res->getString(col_idx);
-		auto enum_val = mysql_str.c_str();
-		auto offset = EnumType::GetPos(type, enum_val);
-		if (offset < 0)
-		{
-			throw IOException("Could not map ENUM value %s", enum_val);
-		}
-		switch (type.InternalType())
-		{
-		case PhysicalType::UINT8:
-			FlatVector::GetData<uint8_t>(out_vec)[output_offset] = (uint8_t)offset;
-			break;
-		case PhysicalType::UINT16:
-			FlatVector::GetData<uint16_t>(out_vec)[output_offset] = (uint16_t)offset;
-			break;
-
-		case PhysicalType::UINT32:
-			FlatVector::GetData<uint32_t>(out_vec)[output_offset] = (uint32_t)offset;
-			break;
-
-		default:
-			throw InternalException("ENUM can only have unsigned integers (except "
-															"UINT64) as physical types, got %s",
-															TypeIdToString(type.InternalType()));
-		}
+		StoreEnumValue(out_vec, type, string_t(mysql_str.c_str(), mysql_str.length()), output_offset);
 		break;
 	}
 		// case LogicalTypeId::INTERVAL:
@@ -334,3 +572,226 @@ static void ProcessValue(
 	}
 }
 
+
+// Column decoders of the JDBC engine. Each one is specialized on the target type and on the nullability
+// of the column, so the scan loop calls them without branching on the type of every cell.
+
+struct MysqlIntegerGetter
+{
+	template <class T>
+	static T Get(sql::ResultSet *res, uint32_t col_idx)
+	{
+		return static_cast<T>(res->getInt(col_idx));
+	}
+};
+
+struct MysqlUnsignedIntegerGetter
+{
+	template <class T>
+	static T Get(sql::ResultSet *res, uint32_t col_idx)
+	{
+		return static_cast<T>(res->getUInt(col_idx));
+	}
+};
+
+struct MysqlBigIntGetter
+{
+	template <class T>
+	static T Get(sql::ResultSet *res, uint32_t col_idx)
+	{
+		return static_cast<T>(res->getInt64(col_idx));
+	}
+};
+
+struct MysqlDoubleGetter
+{
+	template <class T>
+	static T Get(sql::ResultSet *res, uint32_t col_idx)
+	{
+		return static_cast<T>(res->getDouble(col_idx));
+	}
+};
+
+struct MysqlBooleanGetter
+{
+	template <class T>
+	static T Get(sql::ResultSet *res, uint32_t col_idx)
+	{
+		return res->getBoolean(col_idx);
+	}
+};
+
+template <bool NULLABLE>
+static inline bool DecodeNull(sql::ResultSet *res, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (NULLABLE && res->isNull(col_idx))
+	{
+		FlatVector::SetNull(out_vec, output_offset, true);
+		return true;
+	}
+	return false;
+}
+
+template <class T, class GETTER, bool NULLABLE>
+static void DecodeFixedWidth(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (DecodeNull<NULLABLE>(res, out_vec, col_idx, output_offset))
+	{
+		return;
+	}
+	FlatVector::GetData<T>(out_vec)[output_offset] = GETTER::template Get<T>(res, col_idx);
+}
+
+template <bool NULLABLE>
+static void DecodeString(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (DecodeNull<NULLABLE>(res, out_vec, col_idx, output_offset))
+	{
+		return;
+	}
+	auto mysql_str = res->getString(col_idx);
+	FlatVector::GetData<string_t>(out_vec)[output_offset] = StringVector::AddStringOrBlob(out_vec, mysql_str.c_str(), mysql_str.length());
+}
+
+template <class T, bool NULLABLE>
+static void DecodeEnum(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (DecodeNull<NULLABLE>(res, out_vec, col_idx, output_offset))
+	{
+		return;
+	}
+	auto mysql_str = res->getString(col_idx);
+	auto offset = EnumType::GetPos(reader.type, string_t(mysql_str.c_str(), mysql_str.length()));
+	if (offset < 0)
+	{
+		throw IOException("Could not map ENUM value %s", mysql_str.asStdString());
+	}
+	FlatVector::GetData<T>(out_vec)[output_offset] = (T)offset;
+}
+
+template <bool NULLABLE>
+static void DecodeTemporal(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (DecodeNull<NULLABLE>(res, out_vec, col_idx, output_offset))
+	{
+		return;
+	}
+	auto mysql_str = res->getString(col_idx);
+	StoreTemporalValue(out_vec, reader.type, mysql_str.c_str(), mysql_str.length(), output_offset);
+}
+
+template <class T, bool NULLABLE>
+static void DecodeDecimal(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	if (DecodeNull<NULLABLE>(res, out_vec, col_idx, output_offset))
+	{
+		return;
+	}
+	uint8_t width, scale;
+	MysqlDecimalFormat(reader.type, width, scale);
+	auto mysql_str = res->getString(col_idx);
+	FlatVector::GetData<T>(out_vec)[output_offset] = MysqlParseDecimal<T>(mysql_str.c_str(), mysql_str.length(), width, scale);
+}
+
+// the rowid requested by e.g. SELECT count(*) is not backed by a MySQL column, the query returns NULL for it
+static void DecodeRowId(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	FlatVector::SetNull(out_vec, output_offset, true);
+}
+
+// types without a specialized decoder go through the generic conversion
+static void DecodeGeneric(sql::ResultSet *res, const MysqlColumnReader &reader, Vector &out_vec, uint32_t col_idx, idx_t output_offset)
+{
+	ProcessValue(res, reader.type, reader.type_info, out_vec, col_idx - 1, output_offset);
+}
+
+template <bool NULLABLE>
+static mysql_column_decoder_t GetColumnDecoderInternal(const LogicalType &type)
+{
+	switch (type.id())
+	{
+	case LogicalTypeId::TINYINT:
+		return DecodeFixedWidth<int8_t, MysqlIntegerGetter, NULLABLE>;
+	case LogicalTypeId::SMALLINT:
+		return DecodeFixedWidth<int16_t, MysqlIntegerGetter, NULLABLE>;
+	case LogicalTypeId::INTEGER:
+		return DecodeFixedWidth<int32_t, MysqlIntegerGetter, NULLABLE>;
+	case LogicalTypeId::UINTEGER:
+		return DecodeFixedWidth<uint32_t, MysqlUnsignedIntegerGetter, NULLABLE>;
+	case LogicalTypeId::BIGINT:
+		return DecodeFixedWidth<int64_t, MysqlBigIntGetter, NULLABLE>;
+	case LogicalTypeId::FLOAT:
+		return DecodeFixedWidth<float, MysqlDoubleGetter, NULLABLE>;
+	case LogicalTypeId::DOUBLE:
+		return DecodeFixedWidth<double, MysqlDoubleGetter, NULLABLE>;
+	case LogicalTypeId::BOOLEAN:
+		return DecodeFixedWidth<bool, MysqlBooleanGetter, NULLABLE>;
+	case LogicalTypeId::BLOB:
+	case LogicalTypeId::VARCHAR:
+		return DecodeString<NULLABLE>;
+	case LogicalTypeId::DATE:
+	case LogicalTypeId::TIME:
+	case LogicalTypeId::TIMESTAMP:
+		return DecodeTemporal<NULLABLE>;
+	case LogicalTypeId::HUGEINT:
+		return DecodeDecimal<hugeint_t, NULLABLE>;
+	case LogicalTypeId::DECIMAL:
+		switch (type.InternalType())
+		{
+		case PhysicalType::INT16:
+			return DecodeDecimal<int16_t, NULLABLE>;
+		case PhysicalType::INT32:
+			return DecodeDecimal<int32_t, NULLABLE>;
+		case PhysicalType::INT64:
+			return DecodeDecimal<int64_t, NULLABLE>;
+		case PhysicalType::INT128:
+			return DecodeDecimal<hugeint_t, NULLABLE>;
+		default:
+			return DecodeGeneric;
+		}
+	case LogicalTypeId::ENUM:
+		switch (type.InternalType())
+		{
+		case PhysicalType::UINT8:
+			return DecodeEnum<uint8_t, NULLABLE>;
+		case PhysicalType::UINT16:
+			return DecodeEnum<uint16_t, NULLABLE>;
+		case PhysicalType::UINT32:
+			return DecodeEnum<uint32_t, NULLABLE>;
+		default:
+			return DecodeGeneric;
+		}
+	default:
+		return DecodeGeneric;
+	}
+}
+
+// Resolves the decoders of the projected columns, once per local state
+static vector<MysqlColumnReader> GetColumnReaders(const MysqlBindData &bind_data, const vector<column_t> &column_ids)
+{
+	vector<MysqlColumnReader> readers;
+	for (auto column_id : column_ids)
+	{
+		MysqlColumnReader reader;
+		if (column_id == COLUMN_IDENTIFIER_ROW_ID)
+		{
+			reader.decode = DecodeRowId;
+			reader.type = LogicalType::BIGINT;
+			reader.type_info = nullptr;
+			readers.push_back(std::move(reader));
+			continue;
+		}
+		reader.type = bind_data.types[column_id];
+		reader.type_info = &bind_data.columns[column_id].type_info;
+		if (reader.type_info->is_nullable)
+		{
+			reader.decode = GetColumnDecoderInternal<true>(reader.type);
+		}
+		else
+		{
+			reader.decode = GetColumnDecoderInternal<false>(reader.type);
+		}
+		readers.push_back(std::move(reader));
+	}
+	return readers;
+}
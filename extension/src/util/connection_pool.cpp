@@ -2,35 +2,61 @@
 #include "connection_pool.hpp"
 #include <spdlog/spdlog.h>
 
-//TODO support maxPoolSize, currently unbound
-ConnectionPool::ConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password):
-minPoolSize(minPoolSize), maxPoolSize(maxPoolSize), host(host), username(username), password(password)
+#include <algorithm>
+#include <random>
+
+ConnectionPool::ConnectionPool(int minPoolSize, int maxPoolSize, const std::string& host, const std::string& username, const std::string& password,
+                               const ConnectionOptions& options):
+minPoolSize(minPoolSize), maxPoolSize(std::max(minPoolSize, maxPoolSize)), host(host), username(username), password(password), options(options)
 {
   // spdlog::debug("Creating connection pool with size " << poolSize <<);
-
-  std::vector<std::thread> threads(minPoolSize);
   driver = sql::mysql::get_mysql_driver_instance();
+  warmUp(minPoolSize);
+}
+
+void ConnectionPool::warmUp(int count, ConnectionPoolStats *stats)
+{
+  int toOpen;
+  {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    toOpen = std::min(count, maxPoolSize) - openConnections;
+    if (toOpen <= 0) {
+      return;
+    }
+    // reserved up front so that getConnection does not open the same connections concurrently
+    openConnections += toOpen;
+  }
 
-  for (int i = 0; i < minPoolSize; ++i)
+  std::vector<std::thread> threads(toOpen);
+  for (int i = 0; i < toOpen; ++i)
   {
-    threads[i] = std::thread([this, host, username, password]()
+    threads[i] = std::thread([this, stats]()
            {
             // spdlog::debug("Creating connection host " << host << " username " << username << " password " << password <<);
+            sql::Connection* connection = nullptr;
             try {
-               sql::Connection* connection = driver->connect(host, username, password);
+               // same connection options and retries as the connections opened on demand
+               connection = createConnection(3);
                spdlog::info("Connection created");
-               // Add a lock to ensure mutual exclusion when accessing the connections vector
-               std::lock_guard<std::mutex> lock(connectionsMutex);
-               connections.push(connection);
-            } catch (sql::SQLException &e) {
-              spdlog::error("Error connecting to database");
-              spdlog::error(e.what());
-              spdlog::error(e.getErrorCode());
-              spdlog::error(e.getSQLState());
+            } catch (std::exception &e) {
+              spdlog::error("Error connecting to database: {}", e.what());
             } catch (...) {
               spdlog::error("Unknown Error connecting to database");
             }
 
+            {
+              // Add a lock to ensure mutual exclusion when accessing the connections vector
+              std::lock_guard<std::mutex> lock(connectionsMutex);
+              if (connection) {
+                connections.push_back({connection, std::chrono::steady_clock::now()});
+                if (stats) {
+                  stats->creates++;
+                }
+              } else {
+                openConnections--;
+              }
+            }
+            connectionReleased.notify_one();
          });
   }
 
@@ -45,69 +71,203 @@ minPoolSize(minPoolSize), maxPoolSize(maxPoolSize), host(host), username(usernam
 }
 
 sql::Connection *ConnectionPool::createConnection(int retryLeftCount) {
- if(retryLeftCount == 0){
-  throw duckdb::InvalidInputException("Unable to create connection to the host %s with username %s", this->host, this->username);
- } else {
-  try {
-    return this->driver->connect(this->host, this->username, this->password);
-  } catch (...) {
-    return createConnection(retryLeftCount - 1);
+  static thread_local std::default_random_engine randomEngine(std::random_device{}());
+  auto backoff = std::chrono::milliseconds(100);
+  const auto maxBackoff = std::chrono::milliseconds(2000);
+  std::string lastError = "unknown error";
+
+  for (int attempt = 0; attempt < retryLeftCount; attempt++) {
+    if (attempt > 0) {
+      // exponential backoff with jitter, so that parallel scans do not retry in lockstep
+      std::uniform_int_distribution<long> jitter(backoff.count() / 2, backoff.count());
+      std::this_thread::sleep_for(std::chrono::milliseconds(jitter(randomEngine)));
+      backoff = std::min(backoff * 2, maxBackoff);
+    }
+    try {
+      if (this->options.compression.empty()) {
+        return this->driver->connect(this->host, this->username, this->password);
+      }
+      sql::ConnectOptionsMap properties;
+      properties["hostName"] = this->host;
+      properties["userName"] = this->username;
+      properties["password"] = this->password;
+      // both sides must support the algorithm, the server falls back to no compression otherwise
+      properties["OPT_COMPRESSION_ALGORITHMS"] = this->options.compression;
+      if (this->options.compressionLevel != 0) {
+        properties["OPT_ZSTD_COMPRESSION_LEVEL"] = this->options.compressionLevel;
+      }
+      return this->driver->connect(properties);
+    } catch (sql::SQLException &e) {
+      lastError = e.what();
+      spdlog::warn("Error connecting to database: {}", lastError);
+    } catch (...) {
+      lastError = "unknown error";
+      spdlog::warn("Unknown Error connecting to database");
+    }
   }
- }
+  throw duckdb::InvalidInputException("Unable to create connection to the host %s with username %s: %s", this->host, this->username, lastError);
+}
+
+void ConnectionPool::closeConnections(std::vector<sql::Connection *> &toClose)
+{
+  for (auto connection : toClose) {
+    try {
+      connection->close();
+    } catch (...) {
+      spdlog::debug("Error closing connection");
+    }
+    delete connection;
+  }
+  toClose.clear();
+}
+
+// Must be called with connectionsMutex held, the evicted connections are closed by the caller once it is released
+void ConnectionPool::evictIdleConnections(std::vector<sql::Connection *> &toClose)
+{
+  auto now = std::chrono::steady_clock::now();
+  // the least recently used connections are at the front
+  while (!connections.empty() && openConnections > minPoolSize &&
+         now - connections.front().lastUsed > idleTimeout) {
+    spdlog::debug("Evicting idle connection");
+    toClose.push_back(connections.front().connection);
+    connections.pop_front();
+    openConnections--;
+  }
+}
+
+sql::Connection *ConnectionPool::getConnection(ConnectionPoolStats *stats)
+{
+  return acquireConnection(stats, true);
+}
+
+sql::Connection *ConnectionPool::tryGetConnection(ConnectionPoolStats *stats)
+{
+  return acquireConnection(stats, false);
 }
 
-sql::Connection *ConnectionPool::getConnection()
+sql::Connection *ConnectionPool::acquireConnection(ConnectionPoolStats *stats, bool wait)
 {
-  // Add a lock to ensure mutual exclusion when accessing the connections vector
-  std::lock_guard<std::mutex> lock(connectionsMutex);
+  std::vector<sql::Connection *> toClose;
+  std::unique_lock<std::mutex> lock(connectionsMutex);
   spdlog::info("Retrieving connection from pool");
-  // Retrieve the next available connection in a round-robin fashion
+  auto deadline = std::chrono::steady_clock::now() + acquireTimeout;
 
-  sql::Connection *connection = nullptr;
+  while (true) {
+    evictIdleConnections(toClose);
 
-  if(connections.empty()) {
-    spdlog::info("Connection pool is empty");
-    connection = createConnection(3);
-  } else {
-  // front() returns a reference to the first element in the vector
-    connection = connections.front();
-    connections.pop();
-  }
+    if (!connections.empty()) {
+      // hand out the most recently used connection so that the others can idle out
+      auto pooled = connections.back();
+      connections.pop_back();
+      lock.unlock();
+      closeConnections(toClose);
 
-  // check that the connection is still valid
-  if (connection->isValid()) {
-    // spdlog::debug("Connection is valid" <<);
-  } else {
-    spdlog::debug("Connection is invalid");
-    // if the connection is invalid, create a new one
-    delete connection;
-    connection = createConnection(3);
+      // only connections that sat idle for a while are checked, it costs a server round trip
+      auto idleFor = std::chrono::steady_clock::now() - pooled.lastUsed;
+      if (idleFor <= validationInterval || pooled.connection->isValid()) {
+        if (stats) {
+          stats->checkouts++;
+        }
+        return pooled.connection;
+      }
+      spdlog::debug("Connection is invalid");
+      delete pooled.connection;
+      lock.lock();
+      openConnections--;
+      continue;
+    }
+
+    if (openConnections < maxPoolSize) {
+      spdlog::info("Connection pool is empty");
+      // reserve the slot before connecting so that concurrent callers see the pool size, then connect without the lock
+      openConnections++;
+      lock.unlock();
+      closeConnections(toClose);
+      try {
+        auto connection = createConnection(3);
+        if (stats) {
+          stats->checkouts++;
+          stats->creates++;
+        }
+        return connection;
+      } catch (...) {
+        lock.lock();
+        openConnections--;
+        connectionReleased.notify_one();
+        throw;
+      }
+    }
+
+    if (!wait) {
+      lock.unlock();
+      closeConnections(toClose);
+      return nullptr;
+    }
+
+    // the pool is at its maximum size, wait for a connection to be released
+    auto waitStart = std::chrono::steady_clock::now();
+    auto status = connectionReleased.wait_until(lock, deadline);
+    if (stats) {
+      stats->waits++;
+      stats->waitMicros += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - waitStart).count();
+    }
+    if (status == std::cv_status::timeout && connections.empty() && openConnections >= maxPoolSize) {
+      lock.unlock();
+      closeConnections(toClose);
+      throw duckdb::IOException("Timed out waiting for a connection to the host %s, all %d connections of the pool are in use",
+                                this->host, maxPoolSize);
+    }
   }
-  return connection;
 }
 
 void ConnectionPool::releaseConnection(sql::Connection *connection)
 {
-  // Add a lock to ensure mutual exclusion when accessing the connections vector
-  std::lock_guard<std::mutex> lock(connectionsMutex);
-  spdlog::info("Releasing connection back to pool");
-  // Add the released connection back to the pool for reuse
-  connections.push(connection);
+  if (!connection) {
+    return;
+  }
+  std::vector<sql::Connection *> toClose;
+  {
+    // Add a lock to ensure mutual exclusion when accessing the connections vector
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    spdlog::info("Releasing connection back to pool");
+    // Add the released connection back to the pool for reuse
+    connections.push_back({connection, std::chrono::steady_clock::now()});
+    evictIdleConnections(toClose);
+  }
+  connectionReleased.notify_one();
+  closeConnections(toClose);
+}
+
+void ConnectionPool::ensureMaxPoolSize(int size)
+{
+  {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    if (size <= maxPoolSize) {
+      return;
+    }
+    maxPoolSize = size;
+  }
+  // waiters can now open new connections
+  connectionReleased.notify_all();
 }
 
 void ConnectionPool::close()
 {
-  // Add a lock to ensure mutual exclusion when accessing the connections vector
-  std::lock_guard<std::mutex> lock(connectionsMutex);
-  // spdlog::debug("ConnectionPool :: Closing connection pool" <<);
-  // Close all connections in the pool
-  while (!connections.empty())
+  std::vector<sql::Connection *> toClose;
   {
-    sql::Connection *connection = connections.front();
-    connections.pop();
-    connection->close();
-    delete connection;
+    // Add a lock to ensure mutual exclusion when accessing the connections vector
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    // spdlog::debug("ConnectionPool :: Closing connection pool" <<);
+    // Close all idle connections in the pool, checked out ones are closed when they come back and idle out
+    while (!connections.empty())
+    {
+      toClose.push_back(connections.front().connection);
+      connections.pop_front();
+      openConnections--;
+    }
   }
+  connectionReleased.notify_all();
+  closeConnections(toClose);
 }
 
 ConnectionPool::~ConnectionPool()
@@ -1,6 +1,6 @@
 #include "mysql_connection_manager.hpp"
 
-std::map<std::tuple<std::string, std::string, std::string>, ConnectionPool *> MySQLConnectionManager::connectionMap;
+std::map<std::tuple<std::string, std::string, std::string, std::tuple<std::string, int>>, ConnectionPool *> MySQLConnectionManager::connectionMap;
 std::mutex MySQLConnectionManager::mapMutex;
 
 ConnectionPool *MySQLConnectionManager::getConnectionPool(
@@ -8,26 +8,28 @@ ConnectionPool *MySQLConnectionManager::getConnectionPool(
  int maxPoolSize,
  const std::string &host,
  const std::string &username,
- const std::string &password
+ const std::string &password,
+ const ConnectionOptions &options
  )
 {
   // spdlog::debug("Retrieving connection pool" <<);
   
   std::lock_guard<std::mutex> lock(mapMutex);
 
-  auto key = std::make_tuple(host, username, password);
+  auto key = std::make_tuple(host, username, password, options.key());
   auto existing_connection_pool = connectionMap.find(key);
 
   if (existing_connection_pool != connectionMap.end())
   {
     // spdlog::debug("Connection pool already exists, return existing!" <<);
-    // ConnectionPool already exists, return the existing instance
+    // ConnectionPool already exists, return the existing instance, grown to what this caller may need
+    existing_connection_pool->second->ensureMaxPoolSize(maxPoolSize);
     return existing_connection_pool->second;
   }
 
   // spdlog::debug("Connection pool doesn't exist, create new!" <<);
   // ConnectionPool doesn't exist, create a new instance and add it to the map
-  ConnectionPool *connectionPool = new ConnectionPool(minPoolSize, maxPoolSize, host, username, password);
+  ConnectionPool *connectionPool = new ConnectionPool(minPoolSize, maxPoolSize, host, username, password, options);
   connectionMap[key] = connectionPool;
   return connectionPool;
 }
@@ -37,14 +39,17 @@ void MySQLConnectionManager::close(const std::string &host, const std::string &u
   // spdlog::debug("MySQLConnectionManager :: Closing connection pool" <<);
   std::lock_guard<std::mutex> lock(mapMutex);
 
-  auto key = std::make_tuple(host, username, password);
-  auto connection_key = connectionMap.find(key);
-
-  if (connection_key != connectionMap.end())
+  for (auto connection_key = connectionMap.begin(); connection_key != connectionMap.end();)
   {
+    if (std::get<0>(connection_key->first) != host || std::get<1>(connection_key->first) != username ||
+        std::get<2>(connection_key->first) != password)
+    {
+      connection_key++;
+      continue;
+    }
     connection_key->second->close();
     delete connection_key->second;
-    connectionMap.erase(connection_key);
+    connection_key = connectionMap.erase(connection_key);
   }
 }
 
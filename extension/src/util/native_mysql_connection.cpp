@@ -0,0 +1,80 @@
+#include "duckdb.hpp"
+#include "native_mysql_connection.hpp"
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <mutex>
+
+// libmysqlclient must be initialized once before connections get opened from several threads
+static std::once_flag libraryInitFlag;
+
+void NativeMysqlConnection::parseHost(const std::string &host, std::string &hostname, unsigned int &port, std::string &socket)
+{
+  const std::string tcp_prefix = "tcp://";
+  const std::string unix_prefix = "unix://";
+
+  hostname = host;
+  port = 0;
+  socket.clear();
+
+  if (hostname.compare(0, unix_prefix.size(), unix_prefix) == 0) {
+    socket = hostname.substr(unix_prefix.size());
+    hostname = "localhost";
+    return;
+  }
+  if (hostname.compare(0, tcp_prefix.size(), tcp_prefix) == 0) {
+    hostname = hostname.substr(tcp_prefix.size());
+  }
+
+  // a trailing ":<digits>" is the port, anything else (e.g. an IPv6 address) is kept as is
+  auto port_separator = hostname.rfind(':');
+  if (port_separator != std::string::npos && port_separator + 1 < hostname.size() &&
+      hostname.find_first_not_of("0123456789", port_separator + 1) == std::string::npos &&
+      hostname.find(':') == port_separator) {
+    port = std::strtoul(hostname.c_str() + port_separator + 1, nullptr, 10);
+    hostname = hostname.substr(0, port_separator);
+  }
+}
+
+NativeMysqlConnection::NativeMysqlConnection(const std::string &host, const std::string &username, const std::string &password,
+                                             const ConnectionOptions &options)
+{
+  std::string hostname;
+  unsigned int port;
+  std::string socket;
+  parseHost(host, hostname, port, socket);
+
+  std::call_once(libraryInitFlag, []() { mysql_library_init(0, nullptr, nullptr); });
+  mysql = mysql_init(nullptr);
+  if (!mysql) {
+    throw duckdb::IOException("Unable to allocate a MySQL client handle");
+  }
+  if (!options.compression.empty()) {
+    mysql_options(mysql, MYSQL_OPT_COMPRESSION_ALGORITHMS, options.compression.c_str());
+    if (options.compressionLevel != 0) {
+      unsigned int level = options.compressionLevel;
+      mysql_options(mysql, MYSQL_OPT_ZSTD_COMPRESSION_LEVEL, &level);
+    }
+  }
+  if (!mysql_real_connect(mysql, hostname.c_str(), username.c_str(), password.c_str(), nullptr, port,
+                          socket.empty() ? nullptr : socket.c_str(), 0)) {
+    std::string error = mysql_error(mysql);
+    mysql_close(mysql);
+    mysql = nullptr;
+    throw duckdb::IOException("Unable to create connection to the host %s with username %s: %s", host, username, error);
+  }
+  spdlog::info("Native connection created");
+}
+
+void NativeMysqlConnection::close()
+{
+  if (mysql) {
+    mysql_close(mysql);
+    mysql = nullptr;
+  }
+}
+
+NativeMysqlConnection::~NativeMysqlConnection()
+{
+  close();
+}
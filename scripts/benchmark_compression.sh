@@ -0,0 +1,123 @@
+#!/usr/bin/env bash
+# Measures the throughput of mysql_scan with and without protocol compression over a bandwidth limited link.
+#
+# A MySQL 8 server and a toxiproxy limiting the bandwidth in front of it are started with docker, a table of
+# ROWS rows is filled, and the same scan runs with each compression setting. Requires docker, curl and the
+# extension built with `make` (the duckdb shell and the extension are read from build/release).
+#
+#   ./scripts/benchmark_compression.sh
+#   ROWS=2000000 BANDWIDTH_KBPS=10240 RUNS=5 ./scripts/benchmark_compression.sh
+set -euo pipefail
+
+ROWS=${ROWS:-1000000}
+# downstream bandwidth of the link in KB/s, 0 for no limit
+BANDWIDTH_KBPS=${BANDWIDTH_KBPS:-5120}
+RUNS=${RUNS:-3}
+THREADS=${THREADS:-4}
+MYSQL_IMAGE=${MYSQL_IMAGE:-mysql:8.0}
+TOXIPROXY_IMAGE=${TOXIPROXY_IMAGE:-ghcr.io/shopify/toxiproxy:2.9.0}
+PROXY_PORT=${PROXY_PORT:-13306}
+API_PORT=${API_PORT:-18474}
+
+ROOT_DIR=$(cd "$(dirname "$0")/.." && pwd)
+DUCKDB=${DUCKDB:-$ROOT_DIR/build/release/duckdb}
+EXTENSION=${EXTENSION:-$ROOT_DIR/build/release/extension/mysql_scanner/mysql_scanner.duckdb_extension}
+
+NETWORK=mysql-scanner-bench
+MYSQL_CONTAINER=mysql-scanner-bench-mysql
+PROXY_CONTAINER=mysql-scanner-bench-proxy
+PASSWORD=bench
+
+cleanup() {
+  docker rm -f "$MYSQL_CONTAINER" "$PROXY_CONTAINER" >/dev/null 2>&1 || true
+  docker network rm "$NETWORK" >/dev/null 2>&1 || true
+}
+trap cleanup EXIT
+
+for file in "$DUCKDB" "$EXTENSION"; do
+  if [ ! -f "$file" ]; then
+    echo "$file not found, build the extension with make first" >&2
+    exit 1
+  fi
+done
+
+cleanup
+docker network create "$NETWORK" >/dev/null
+docker run -d --name "$MYSQL_CONTAINER" --network "$NETWORK" -e MYSQL_ROOT_PASSWORD="$PASSWORD" \
+  "$MYSQL_IMAGE" --protocol-compression-algorithms=zlib,zstd,uncompressed >/dev/null
+docker run -d --name "$PROXY_CONTAINER" --network "$NETWORK" -p "$PROXY_PORT:$PROXY_PORT" -p "$API_PORT:8474" \
+  "$TOXIPROXY_IMAGE" >/dev/null
+
+echo "waiting for MySQL to start"
+until docker exec "$MYSQL_CONTAINER" mysql -uroot -p"$PASSWORD" -e "SELECT 1" >/dev/null 2>&1; do
+  sleep 1
+done
+
+mysql_exec() {
+  docker exec -i "$MYSQL_CONTAINER" mysql -uroot -p"$PASSWORD" "$@" 2>/dev/null
+}
+
+echo "filling bench.orders with $ROWS rows"
+mysql_exec <<SQL
+CREATE DATABASE IF NOT EXISTS bench;
+DROP TABLE IF EXISTS bench.orders;
+CREATE TABLE bench.orders (
+  id BIGINT NOT NULL PRIMARY KEY,
+  status VARCHAR(16) NOT NULL,
+  customer VARCHAR(64) NOT NULL,
+  note VARCHAR(255) NOT NULL,
+  total DECIMAL(12, 2) NOT NULL,
+  created_at DATETIME NOT NULL
+);
+SET SESSION cte_max_recursion_depth = $ROWS;
+INSERT INTO bench.orders
+WITH RECURSIVE seq (n) AS (SELECT 1 UNION ALL SELECT n + 1 FROM seq WHERE n < $ROWS)
+SELECT n,
+       ELT(1 + n % 4, 'pending', 'paid', 'shipped', 'delivered'),
+       CONCAT('customer-', n % 10000, '@example.com'),
+       CONCAT('order ', n, ' placed through the web shop, delivery to the default address'),
+       (n % 100000) / 100,
+       TIMESTAMP '2023-01-01 00:00:00' + INTERVAL (n % 31536000) SECOND
+FROM seq;
+ANALYZE TABLE bench.orders;
+SQL
+
+# the scans go through the proxy, which limits the bandwidth from MySQL to the client
+curl -sf -X POST "http://127.0.0.1:$API_PORT/proxies" \
+  -d "{\"name\": \"mysql\", \"listen\": \"0.0.0.0:$PROXY_PORT\", \"upstream\": \"$MYSQL_CONTAINER:3306\"}" >/dev/null
+if [ "$BANDWIDTH_KBPS" -gt 0 ]; then
+  curl -sf -X POST "http://127.0.0.1:$API_PORT/proxies/mysql/toxics" \
+    -d "{\"type\": \"bandwidth\", \"stream\": \"downstream\", \"attributes\": {\"rate\": $BANDWIDTH_KBPS}}" >/dev/null
+fi
+
+run_scan() {
+  local options=$1
+  "$DUCKDB" -unsigned -noheader -list <<SQL
+SET threads = $THREADS;
+LOAD '$EXTENSION';
+SELECT COUNT(*), SUM(LENGTH(note))
+FROM mysql_scan('tcp://127.0.0.1:$PROXY_PORT', 'root', '$PASSWORD', 'bench', 'orders'$options);
+SQL
+}
+
+echo
+echo "rows: $ROWS, bandwidth: ${BANDWIDTH_KBPS} KB/s, threads: $THREADS, runs: $RUNS"
+printf "%-24s %12s %14s\n" "compression" "seconds" "rows/s"
+for setting in "none" "zlib" "zstd" "zstd:1" "zstd:10"; do
+  case $setting in
+    none) options="" ;;
+    zstd:*) options=", compression = 'zstd', compression_level = ${setting#zstd:}" ;;
+    *) options=", compression = '$setting'" ;;
+  esac
+  best=""
+  for _ in $(seq "$RUNS"); do
+    start=$(date +%s.%N)
+    run_scan "$options" >/dev/null
+    end=$(date +%s.%N)
+    elapsed=$(echo "$end - $start" | bc)
+    if [ -z "$best" ] || [ "$(echo "$elapsed < $best" | bc)" -eq 1 ]; then
+      best=$elapsed
+    fi
+  done
+  printf "%-24s %12.2f %14.0f\n" "$setting" "$best" "$(echo "$ROWS / $best" | bc -l)"
+done